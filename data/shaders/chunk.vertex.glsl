@@ -0,0 +1,12 @@
+#version 330 core
+
+layout(location = 0) in vec2 pos; // world-space position
+layout(location = 1) in vec4 vertexColor;
+uniform vec4 view; // world-to-window scale (xy) and camera shift (zw)
+out vec4 color;
+
+void main()
+{
+    gl_Position = vec4(pos * view.xy - 1.0 + view.zw, 0.0, 1.0);
+    color = vertexColor;
+}
\ No newline at end of file
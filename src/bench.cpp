@@ -0,0 +1,652 @@
+// standard libraries
+#include <iostream> // for the report
+#include <fstream> // for writing the sprite files
+#include <iomanip> // for formatting the report
+#include <string> // for when const char* won't work
+#include <vector>
+#include <algorithm> // for std::sort
+#include <cstdlib> // for std::atoi and std::strtol
+#include <cmath> // for std::sqrt
+#include <cstring> // for std::memcpy
+
+// public (external) libraries
+#include <glad/glad.h> // loader for OpenGL
+#include <GLFW/glfw3.h> // API for window creation
+#ifndef _WIN32
+    #include <EGL/egl.h> // contexts without a window system
+    #include <EGL/eglext.h>
+#endif
+
+// local headers
+#include "bench.h"
+#include "const.h"
+
+namespace {
+    // upper limit for --rects (the rects are also kept on the CPU, about 100 bytes each)
+    const int MAX_RECTS = 1000000;
+
+    // how the GL context is created
+    enum class ContextAPI { AUTO, WINDOW, SURFACELESS, DEVICE };
+
+    // benchmark options
+    struct BenchOptions {
+        int rects = 1000;
+        int staticRects = 0;
+        int glyphs = 1000;
+        int particles = 0;
+        int textures = 0;
+        int textureSize = 256;
+        bool overlay = false;
+        int frames = 300;
+        int warmup = 30;
+        ContextAPI contextAPI = ContextAPI::AUTO;
+        std::string font;
+    };
+
+    // measurements of one frame
+    struct FrameSample {
+        double submit; // CPU time spent issuing GL calls (seconds)
+        double frame; // submit time plus the time the GL took to finish the frame (seconds)
+        double particles; // CPU time of the particle update (seconds, part of submit)
+        double textures; // CPU time of the texture loader update (seconds, part of submit)
+        lgw::GLCallStats calls;
+    };
+
+    // parse the command line (returns false on unknown options)
+    bool parseOptions(int argc, char** argv, BenchOptions& options)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            std::string arg = argv[i];
+            bool hasValue = (i + 1 < argc);
+            if (arg == "--bench")
+                continue;
+            else if (arg == "--overlay")
+                options.overlay = true;
+            else if (arg == "--rects" && hasValue)
+            {
+                char* end;
+                long rects = std::strtol(argv[++i], &end, 10);
+                if (*end != '\0' || end == argv[i] || rects < 0 || rects > MAX_RECTS)
+                {
+                    std::cout << "bench: --rects must be a number from 0 to " << MAX_RECTS << std::endl;
+                    return false;
+                }
+                options.rects = (int)rects;
+            }
+            else if (arg == "--static" && hasValue)
+                options.staticRects = std::atoi(argv[++i]);
+            else if (arg == "--glyphs" && hasValue)
+                options.glyphs = std::atoi(argv[++i]);
+            else if (arg == "--particles" && hasValue)
+                options.particles = std::max(0, std::atoi(argv[++i]));
+            else if (arg == "--textures" && hasValue)
+                options.textures = std::max(0, std::atoi(argv[++i]));
+            else if (arg == "--texture-size" && hasValue)
+                options.textureSize = std::min(4096, std::max(1, std::atoi(argv[++i])));
+            else if (arg == "--frames" && hasValue)
+                options.frames = std::max(1, std::atoi(argv[++i]));
+            else if (arg == "--warmup" && hasValue)
+                options.warmup = std::atoi(argv[++i]);
+            else if (arg == "--font" && hasValue)
+                options.font = argv[++i];
+            else if (arg == "--context" && hasValue)
+            {
+                std::string api = argv[++i];
+                if (api == "auto")
+                    options.contextAPI = ContextAPI::AUTO;
+                else if (api == "window")
+                    options.contextAPI = ContextAPI::WINDOW;
+                else if (api == "surfaceless")
+                    options.contextAPI = ContextAPI::SURFACELESS;
+                else if (api == "device")
+                    options.contextAPI = ContextAPI::DEVICE;
+                else
+                {
+                    std::cout << "bench: unknown context " << api << std::endl;
+                    return false;
+                }
+            }
+            else
+            {
+                std::cout << "bench: unknown option " << arg << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // GL context that is never shown: an invisible GLFW window, or (except on Windows) an EGL context without any surface,
+    // which doesn't need an X11 or Wayland display and so also runs on CI machines without one
+    class OffscreenContext {
+    private:
+        bool glfwStarted = false;
+        GLFWwindow* window = nullptr;
+    #ifndef _WIN32
+        EGLDisplay display = EGL_NO_DISPLAY;
+        EGLContext context = EGL_NO_CONTEXT;
+
+        // EGL: create a 3.3 core context on the surfaceless Mesa platform or on the first EGL device
+        int createEGL(ContextAPI api)
+        {
+            const char* extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+            std::string clientExtensions = (extensions != nullptr) ? extensions : "";
+            PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+            if (getPlatformDisplay == nullptr)
+                return -1;
+            if (api == ContextAPI::SURFACELESS)
+            {
+                if (clientExtensions.find("EGL_MESA_platform_surfaceless") == std::string::npos)
+                    return -1;
+                display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+            }
+            else
+            {
+                PFNEGLQUERYDEVICESEXTPROC queryDevices = (PFNEGLQUERYDEVICESEXTPROC)eglGetProcAddress("eglQueryDevicesEXT");
+                EGLDeviceEXT device;
+                EGLint deviceCount = 0;
+                if (clientExtensions.find("EGL_EXT_platform_device") == std::string::npos || queryDevices == nullptr
+                    || !queryDevices(1, &device, &deviceCount) || deviceCount < 1)
+                    return -1;
+                display = getPlatformDisplay(EGL_PLATFORM_DEVICE_EXT, device, nullptr);
+            }
+            if (display == EGL_NO_DISPLAY || !eglInitialize(display, nullptr, nullptr))
+            {
+                display = EGL_NO_DISPLAY;
+                return -1;
+            }
+
+            // nothing is drawn into a surface (the benchmark has its own framebuffer), the config only picks the context type
+            EGLint configAttributes[] = { EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_NONE };
+            EGLConfig config;
+            EGLint configCount = 0;
+            if (!eglBindAPI(EGL_OPENGL_API) || !eglChooseConfig(display, configAttributes, &config, 1, &configCount) || configCount < 1)
+                return -1;
+            EGLint contextAttributes[] = {
+                EGL_CONTEXT_MAJOR_VERSION, 3,
+                EGL_CONTEXT_MINOR_VERSION, 3,
+                EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+                EGL_NONE
+            };
+            context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+            if (context == EGL_NO_CONTEXT || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context))
+                return -1;
+            if (!gladLoadGLLoader((GLADloadproc)eglGetProcAddress))
+            {
+                std::cout << "glad: init failed" << std::endl;
+                return -1;
+            }
+            return 0;
+        }
+    #endif
+        // glfw: invisible window whose only purpose is to own the context (needs a display)
+        int createWindow(int width, int height, const std::string& title)
+        {
+            if (!glfwInit())
+            {
+                std::cout << "glfw: init failed" << std::endl;
+                return -1;
+            }
+            glfwStarted = true;
+            glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+            glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+            glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+            #ifdef __APPLE__
+                glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+            #endif
+            glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+            window = glfwCreateWindow(width, height, title.c_str(), NULL, NULL);
+            if (window == NULL)
+                return -1;
+            glfwMakeContextCurrent(window);
+            glfwSwapInterval(0);
+            if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+            {
+                std::cout << "glad: init failed" << std::endl;
+                return -1;
+            }
+            return 0;
+        }
+        // destroy whatever was created
+        void destroy(void)
+        {
+        #ifndef _WIN32
+            if (display != EGL_NO_DISPLAY)
+            {
+                eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+                if (context != EGL_NO_CONTEXT)
+                    eglDestroyContext(display, context);
+                eglTerminate(display);
+            }
+            display = EGL_NO_DISPLAY;
+            context = EGL_NO_CONTEXT;
+        #endif
+            if (glfwStarted)
+                glfwTerminate();
+            glfwStarted = false;
+            window = nullptr;
+        }
+    public:
+        // destructor
+        ~OffscreenContext(void) { destroy(); }
+        // create the context, make it current and load the GL functions (auto tries surfaceless EGL, then an EGL device,
+        // then a window; on Windows it always uses a window)
+        int create(ContextAPI api, int width, int height, const std::string& title)
+        {
+        #ifndef _WIN32
+            const char* names[] = { "auto", "window", "surfaceless", "device" };
+            ContextAPI tries[3] = { api };
+            int tryCount = 1;
+            if (api == ContextAPI::AUTO)
+            {
+                tries[0] = ContextAPI::SURFACELESS;
+                tries[1] = ContextAPI::DEVICE;
+                tries[2] = ContextAPI::WINDOW;
+                tryCount = 3;
+            }
+            for (int i = 0; i < tryCount; i++)
+            {
+                if (tries[i] == ContextAPI::WINDOW ? createWindow(width, height, title) == 0 : createEGL(tries[i]) == 0)
+                {
+                    std::cout << "bench: " << names[(int)tries[i]] << " context" << std::endl;
+                    return 0;
+                }
+                destroy();
+            }
+            std::cout << "bench: failed to create a " << names[(int)api] << " context" << std::endl;
+            return -1;
+        #else
+            if (api == ContextAPI::SURFACELESS || api == ContextAPI::DEVICE)
+            {
+                std::cout << "bench: EGL contexts are not available on Windows" << std::endl;
+                return -1;
+            }
+            if (createWindow(width, height, title))
+            {
+                std::cout << "glfw: failed to create offscreen context" << std::endl;
+                destroy();
+                return -1;
+            }
+            return 0;
+        #endif
+        }
+    };
+
+    // write an uncompressed 32-bit TGA sprite with a pattern that depends on the seed (returns false if the file can't be written)
+    bool writeSprite(const std::string& dir, int size, int seed)
+    {
+        std::ofstream file(dir, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+            return false;
+        // header: uncompressed true color, 32 bits per pixel, 8 alpha bits, top row first
+        unsigned char header[18] = { 0 };
+        header[2] = 2;
+        header[12] = (unsigned char)(size & 0xFF);
+        header[13] = (unsigned char)(size >> 8);
+        header[14] = header[12];
+        header[15] = header[13];
+        header[16] = 32;
+        header[17] = 0x28;
+        file.write((const char*)header, sizeof(header));
+        std::vector<unsigned char> pixels((size_t)size * size * 4);
+        for (int y = 0; y < size; y++)
+        {
+            for (int x = 0; x < size; x++)
+            {
+                unsigned char* pixel = &pixels[((size_t)y * size + x) * 4];
+                pixel[0] = (unsigned char)(x * 255 / size);
+                pixel[1] = (unsigned char)(y * 255 / size);
+                pixel[2] = (unsigned char)(seed * 37);
+                pixel[3] = (((x / 16) + (y / 16) + seed) % 2) ? 255 : 128;
+            }
+        }
+        file.write((const char*)pixels.data(), pixels.size());
+        return file.good();
+    }
+
+    // value below which the given fraction of the sorted samples lie
+    double percentile(const std::vector<double>& sorted, double fraction)
+    {
+        size_t index = (size_t)(fraction * (sorted.size() - 1) + 0.5);
+        return sorted[index];
+    }
+
+    // print average, median, 95th/99th percentile and maximum of a series (in milliseconds)
+    void report(const char* name, std::vector<double> values)
+    {
+        std::sort(values.begin(), values.end());
+        double sum = 0.0;
+        for (double value : values)
+            sum += value;
+        std::cout << std::left << std::setw(16) << name << std::right << std::fixed << std::setprecision(3)
+            << " avg " << std::setw(8) << sum / values.size() * 1000.0
+            << "  p50 " << std::setw(8) << percentile(values, 0.50) * 1000.0
+            << "  p95 " << std::setw(8) << percentile(values, 0.95) * 1000.0
+            << "  p99 " << std::setw(8) << percentile(values, 0.99) * 1000.0
+            << "  max " << std::setw(8) << values.back() * 1000.0 << "  ms" << std::endl;
+    }
+}
+
+// headless render benchmark
+int runBenchmark(lgw::Settings& settings, int argc, char** argv)
+{
+    BenchOptions options;
+    if (!parseOptions(argc, argv, options))
+        return -1;
+    if (options.font.empty())
+        options.font = settings.font_dir;
+
+    // offscreen context (destroyed last, after every GL object)
+    OffscreenContext context;
+    if (context.create(options.contextAPI, settings.window_width, settings.window_height, settings.window_title))
+        return -1;
+    lgw::installGLCallCounters();
+
+    // render into a framebuffer object so the results don't depend on the window (or the lack of one)
+    GLuint FBO, colorBuffer;
+    glGenFramebuffers(1, &FBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+    glGenRenderbuffers(1, &colorBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, settings.window_width, settings.window_height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        std::cout << "gl: offscreen framebuffer is incomplete" << std::endl;
+        return -1;
+    }
+    glViewport(0, 0, settings.window_width, settings.window_height);
+
+    // shader programs
+    lgw::Shader* basicShader = lgw::createShader(settings.shader_dir + "basic.vertex.glsl", settings.shader_dir + "basic.fragment.glsl");
+    lgw::Shader* textureShader = lgw::createShader(settings.shader_dir + "texture.vertex.glsl", settings.shader_dir + "texture.fragment.glsl");
+    lgw::Shader* chunkShader = lgw::createShader(settings.shader_dir + "chunk.vertex.glsl", settings.shader_dir + "chunk.fragment.glsl");
+    if (basicShader == nullptr || textureShader == nullptr || chunkShader == nullptr)
+        return -1;
+
+    // same buffer layout as the game loop
+    unsigned int rectIndices[6] = {
+        0, 1, 3,
+        1, 2, 3
+    };
+    lgw::StreamBuffer* streamBuffer = new lgw::StreamBuffer();
+    streamBuffer->init();
+    GLuint VAO_basic, EBO_basic;
+    glGenVertexArrays(1, &VAO_basic);
+    glBindVertexArray(VAO_basic);
+    glBindBuffer(GL_ARRAY_BUFFER, streamBuffer->id);
+    glGenBuffers(1, &EBO_basic);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO_basic);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(rectIndices), rectIndices, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    GLuint VAO_texture;
+    glGenVertexArrays(1, &VAO_texture);
+    glBindVertexArray(VAO_texture);
+    glBindBuffer(GL_ARRAY_BUFFER, streamBuffer->id);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), 0);
+    glEnableVertexAttribArray(0);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // text is skipped if the font can't be loaded (e.g. the Windows font path on a CI machine)
+    lgw::FontLibrary ftLibrary;
+    ftLibrary.init();
+    lgw::Font font(ftLibrary, options.font.c_str(), 128);
+    if ((options.glyphs > 0 || options.overlay) && font.load())
+    {
+        std::cout << "bench: failed to load font " << options.font << "; text is not rendered" << std::endl;
+        options.glyphs = 0;
+        options.overlay = false;
+    }
+
+    // scene: dynamic rectangles spread over the visible world
+    std::vector<lgw::Object> rects;
+    rects.reserve(options.rects);
+    int columns = std::max(1, (int)std::sqrt((float)options.rects * settings.window_aspect_ratio_dec));
+    float cellWidth = settings.window_virtual_width / columns;
+    float cellHeight = settings.window_virtual_height / std::max(1, (options.rects + columns - 1) / columns);
+    for (int i = 0; i < options.rects; i++)
+    {
+        lgw::Point p1((i % columns) * cellWidth, (i / columns) * cellHeight);
+        rects.emplace_back(p1, lgw::Point(p1.x + cellWidth * 0.8f, p1.y + cellHeight * 0.8f));
+        rects.back().velocity = lgw::Vector(((i % 7) - 3) * 0.1f, ((i % 5) - 2) * 0.1f);
+    }
+    // scene: static rectangles baked into chunks
+    lgw::ChunkRenderer* staticLevel = new lgw::ChunkRenderer();
+    float staticColor[4] = { 0.0f, 1.0f, 0.5f, 1.0f };
+    for (int i = 0; i < options.staticRects; i++)
+    {
+        lgw::Point p1((float)(i % 256), (float)(i / 256));
+        staticLevel->addRect(p1, lgw::Point(p1.x + 0.9f, p1.y + 0.9f), staticColor);
+    }
+    // scene: particles from an emitter in the middle of the view that replaces them as fast as they die
+    lgw::ParticleSystem* particles = new lgw::ParticleSystem(std::max(options.particles, 1));
+    particles->init(*streamBuffer);
+    particles->setBounds(lgw::Box(lgw::Point(0.0f, 0.0f), lgw::Point(settings.window_virtual_width, settings.window_virtual_height)));
+    lgw::ParticleEmitter emitter;
+    emitter.position = lgw::Point(settings.window_virtual_width / 2.0f, settings.window_virtual_height / 2.0f);
+    emitter.lifetime = 2.0f;
+    emitter.rate = options.particles / emitter.lifetime;
+    emitter.velocity = lgw::Vector(0.0f, 5.0f);
+    emitter.velocityJitter = lgw::Vector(5.0f, 5.0f);
+    emitter.collide = true;
+    particles->addEmitter(emitter);
+    particles->burst(emitter, options.particles);
+    // scene: lines of text that add up to the requested number of glyphs
+    const int glyphsPerLine = 60;
+    std::vector<std::string> lines;
+    for (int remaining = options.glyphs; remaining > 0; remaining -= glyphsPerLine)
+    {
+        std::string line;
+        for (int i = 0; i < std::min(remaining, glyphsPerLine); i++)
+            line += (char)('!' + (i + (int)lines.size()) % 90);
+        lines.push_back(line);
+    }
+
+    // scene: sprites written into the cache directory and loaded through the texture loader at the start of the measured
+    // frames and again every TEXTURE_RELOAD_INTERVAL frames, like a level transition
+    const int TEXTURE_RELOAD_INTERVAL = 100;
+    std::string spriteDir = settings.cache_dir + "bench/";
+    if (options.textures > 0 && (lgw::createDirectory(settings.cache_dir) || lgw::createDirectory(spriteDir)))
+    {
+        std::cout << "bench: failed to create " << spriteDir << "; textures are not loaded" << std::endl;
+        options.textures = 0;
+    }
+    for (int i = 0; i < options.textures; i++)
+    {
+        if (!writeSprite(spriteDir + "sprite" + std::to_string(i) + ".tga", options.textureSize, i))
+        {
+            std::cout << "bench: failed to write the sprites into " << spriteDir << "; textures are not loaded" << std::endl;
+            options.textures = 0;
+        }
+    }
+    lgw::JobSystem jobs;
+    jobs.init();
+    lgw::TextureLoader* textures = new lgw::TextureLoader(spriteDir);
+    textures->init(jobs);
+    std::vector<int> textureHandles;
+    textureHandles.reserve(options.textures);
+    // frames from each acquire until every texture was ready
+    std::vector<double> textureLoadFrames;
+    int textureLoadStart = -1;
+
+    std::cout << "bench: " << glGetString(GL_RENDERER) << " (" << glGetString(GL_VERSION) << ")" << std::endl;
+    std::cout << "bench: " << options.rects << " dynamic rects, " << options.staticRects << " static rects, "
+        << options.glyphs << " glyphs, " << options.particles << " particles, " << options.textures << " textures of " << options.textureSize << "x" << options.textureSize << ", overlay " << (options.overlay ? "on" : "off") << ", "
+        << options.frames << " frames" << std::endl;
+
+    float rectColor[4] = { 0.0f, 0.5f, 1.0f, 1.0f };
+    std::vector<FrameSample> samples;
+    samples.reserve(options.frames);
+    lgw::Stopwatch frameStopwatch;
+    for (int frame = 0; frame < options.warmup + options.frames; frame++)
+    {
+        lgw::resetGLCallStats();
+        frameStopwatch.reset();
+
+        glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        // textures: drop the previous set and request all of them again, then upload what finished decoding (like the game loop)
+        double textureTime = 0.0;
+        if (options.textures > 0)
+        {
+            double textureStart = frameStopwatch.get();
+            if (frame >= options.warmup && (frame - options.warmup) % TEXTURE_RELOAD_INTERVAL == 0)
+            {
+                for (int handle : textureHandles)
+                    textures->release(handle);
+                textureHandles.clear();
+                for (int i = 0; i < options.textures; i++)
+                    textureHandles.push_back(textures->acquire("sprite" + std::to_string(i) + ".tga"));
+                textureLoadStart = frame;
+            }
+            textures->update();
+            if (textureLoadStart >= 0 && textures->pending() == 0)
+            {
+                textureLoadFrames.push_back(frame - textureLoadStart + 1);
+                textureLoadStart = -1;
+            }
+            textureTime = frameStopwatch.get() - textureStart;
+        }
+
+        // text
+        if (!lines.empty())
+        {
+            font.startRender(VAO_texture, *streamBuffer, textureShader, settings.window_width, settings.window_height);
+            for (size_t i = 0; i < lines.size(); i++)
+                font.render(textureShader, lines[i], 5.0f, settings.window_height - 30.0f * (i % 28 + 1), 1.0f, glm::vec3(0.8f, 0.8f, 0.8f));
+            font.stopRender();
+        }
+        // debug overlay (the same lines the game draws)
+        if (options.overlay)
+        {
+            font.startRender(VAO_texture, *streamBuffer, textureShader, settings.window_width, settings.window_height);
+            font.render(textureShader, "FPS: 60 / 60", 5.0f, 870.0f, 1.0f, glm::vec3(0.0, 0.8f, 0.8f));
+            font.render(textureShader, "Move player : W A S D", 5.0f, 840.0f, 1.0f, glm::vec3(0.8, 0.8f, 0.8f));
+            font.render(textureShader, "Respawn : T", 5.0f, 810.0f, 1.0f, glm::vec3(0.8, 0.8f, 0.8f));
+            font.render(textureShader, "Move scene : I J K L", 5.0f, 780.0f, 1.0f, glm::vec3(0.8, 0.8f, 0.8f));
+            font.render(textureShader, "Change scene scale : F G", 5.0f, 750.0f, 1.0f, glm::vec3(0.8, 0.8f, 0.8f));
+            font.render(textureShader, "Reset scene : Y", 5.0f, 720.0f, 1.0f, glm::vec3(0.8, 0.8f, 0.8f));
+            font.render(textureShader, "Toggle wireframe mode : SPACE", 5.0f, 690.0f, 1.0f, glm::vec3(0.8, 0.8f, 0.8f));
+            font.render(textureShader, "Visible: 0 / 0   Chunks: 0 / 0", 5.0f, 660.0f, 1.0f, glm::vec3(0.0, 0.8f, 0.8f));
+            font.render(textureShader, "Textures: 0 / 0", 5.0f, 630.0f, 1.0f, glm::vec3(0.0, 0.8f, 0.8f));
+            font.render(textureShader, "Pacing: 0.00 ms avg   0.00 ms max   0 missed", 5.0f, 600.0f, 1.0f, glm::vec3(0.0, 0.8f, 0.8f));
+            font.stopRender();
+        }
+
+        // static geometry
+        lgw::Box view = lgw::viewBox(settings.window_aspect_ratio_dec, settings.inv_scale_factor, settings.camera_position_x, settings.camera_position_y);
+        staticLevel->bake();
+        staticLevel->render(chunkShader, view, settings.window_aspect_ratio_dec, settings.inv_scale_factor, settings.camera_position_x, settings.camera_position_y);
+
+        // dynamic rectangles (streamed in batches like the game loop, one map per batch, then one draw per object)
+        if (!rects.empty())
+        {
+            glBindVertexArray(VAO_basic);
+            basicShader->use();
+            glUniform4f(basicShader->uniLoc("color"), rectColor[0], rectColor[1], rectColor[2], rectColor[3]);
+            for (size_t first = 0; first < rects.size(); first += CONST::OBJECT_BATCH)
+            {
+                size_t last = std::min(rects.size(), first + CONST::OBJECT_BATCH);
+                GLintptr streamOffset;
+                float* streamed = (float*)streamBuffer->map(sizeof(float) * 8 * (long long)(last - first), sizeof(float) * 2, streamOffset);
+                if (streamed == nullptr)
+                    continue;
+                for (size_t i = first; i < last; i++)
+                {
+                    rects[i].calcTimeStep(1.0f / 60.0f, 0.0f, 0.0f);
+                    rects[i].setVertices(settings.window_aspect_ratio_dec, settings.inv_scale_factor, settings.camera_position_x, settings.camera_position_y);
+                    std::memcpy(streamed + (i - first) * 8, rects[i].vertices, sizeof(rects[i].vertices));
+                }
+                streamBuffer->unmap();
+                GLint firstVertex = (GLint)(streamOffset / (sizeof(float) * 2));
+                for (size_t i = first; i < last; i++)
+                    glDrawElementsBaseVertex(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, firstVertex + (GLint)(i - first) * 4);
+            }
+            glBindVertexArray(0);
+        }
+        // particles (one streamed draw)
+        double particleTime = 0.0;
+        if (options.particles > 0)
+        {
+            double particleStart = frameStopwatch.get();
+            particles->update(1.0f / 60.0f);
+            particleTime = frameStopwatch.get() - particleStart;
+            particles->render(*streamBuffer, chunkShader, settings.window_aspect_ratio_dec, settings.inv_scale_factor, settings.camera_position_x, settings.camera_position_y, 2.0f);
+        }
+        streamBuffer->endFrame();
+
+        double submit = frameStopwatch.get();
+        // wait for the GL to finish so the frame time includes the actual rendering
+        glFinish();
+        double frameTime = frameStopwatch.get();
+
+        if (frame >= options.warmup)
+            samples.push_back({ submit, frameTime, particleTime, textureTime, lgw::glCallStats });
+    }
+
+    // report
+    std::vector<double> submitTimes, frameTimes, particleTimes, textureTimes;
+    lgw::GLCallStats totals;
+    for (FrameSample& sample : samples)
+    {
+        submitTimes.push_back(sample.submit);
+        frameTimes.push_back(sample.frame);
+        particleTimes.push_back(sample.particles);
+        textureTimes.push_back(sample.textures);
+        totals.total += sample.calls.total;
+        totals.draws += sample.calls.draws;
+        totals.uploads += sample.calls.uploads;
+        totals.uniforms += sample.calls.uniforms;
+        totals.binds += sample.calls.binds;
+    }
+    report("cpu submit", submitTimes);
+    report("frame", frameTimes);
+    if (options.particles > 0)
+        report("particle update", particleTimes);
+    if (options.textures > 0)
+    {
+        report("texture update", textureTimes);
+        // hitches: frames that took more than twice the median frame time
+        std::vector<double> sorted = frameTimes;
+        std::sort(sorted.begin(), sorted.end());
+        double median = percentile(sorted, 0.50);
+        int hitches = 0;
+        for (double frameTime : frameTimes)
+            hitches += (frameTime > 2.0 * median) ? 1 : 0;
+        int failed = 0;
+        for (int handle : textureHandles)
+            failed += textures->failed(handle) ? 1 : 0;
+        std::cout << "textures         " << textureLoadFrames.size() << " loads";
+        if (!textureLoadFrames.empty())
+        {
+            std::sort(textureLoadFrames.begin(), textureLoadFrames.end());
+            std::cout << ", ready after " << std::setprecision(0) << percentile(textureLoadFrames, 0.50) << " frames (max " << textureLoadFrames.back() << ")";
+        }
+        std::cout << ", " << failed << " failed, " << hitches << " hitches (frames over 2x the median)" << std::endl;
+    }
+    std::cout << "gl calls/frame   total " << totals.total / (long long)samples.size()
+        << "  draws " << totals.draws / (long long)samples.size()
+        << "  uploads " << totals.uploads / (long long)samples.size()
+        << "  uniforms " << totals.uniforms / (long long)samples.size()
+        << "  binds " << totals.binds / (long long)samples.size() << std::endl;
+    std::cout << "stream buffer    orphans " << streamBuffer->orphans() << std::endl;
+
+    // gl: de-allocate all resources
+    delete textures;
+    delete staticLevel;
+    delete particles;
+    glDeleteVertexArrays(1, &VAO_basic);
+    glDeleteBuffers(1, &EBO_basic);
+    glDeleteVertexArrays(1, &VAO_texture);
+    delete streamBuffer;
+    glDeleteRenderbuffers(1, &colorBuffer);
+    glDeleteFramebuffers(1, &FBO);
+    delete basicShader;
+    delete textureShader;
+    delete chunkShader;
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,23 @@
+#pragma once
+
+// local headers
+#include "lgwrap/lgwrap.h"
+
+// headless render benchmark: draws a parameterized scene into an offscreen framebuffer through the lgwrap renderers
+// and reports CPU submit time, GL call counts and frame time
+//
+// usage: "2D platformer" --bench [options]
+//   --rects N        dynamic rectangles submitted per frame (default 1000)
+//   --static N       rectangles baked into the chunk renderer (default 0)
+//   --glyphs N       text glyphs rendered per frame (default 1000)
+//   --particles N    particles kept alive by an emitter (default 0)
+//   --textures N     sprites loaded through the texture loader every 100 frames (default 0; written into cache_dir/bench/)
+//   --texture-size N width and height of the sprites in pixels (default 256)
+//   --overlay        also draw the debug overlay
+//   --frames N       measured frames (default 300)
+//   --warmup N       frames rendered before measuring (default 30)
+//   --context API    auto, window, surfaceless or device (default auto: EGL on the surfaceless Mesa platform, then the
+//                    first EGL device, then an invisible GLFW window; the EGL contexts need no display and aren't
+//                    available on Windows, where auto always uses the window)
+//   --font DIR       font file (default: font_dir from the settings file)
+int runBenchmark(lgw::Settings& settings, int argc, char** argv);
\ No newline at end of file
@@ -1,5 +1,10 @@
 #pragma once
 
+#include <cstddef> // for size_t
+
 namespace CONST {
-	const char* SETTINGS_DIR = "data/settings.txt";
+	const char* const SETTINGS_DIR = "data/settings.txt";
+	const char* const TRACE_DIR = "trace.json";
+	// objects written into the stream buffer with one map (a level can have more than the buffer holds)
+	const size_t OBJECT_BATCH = 4096;
 }
\ No newline at end of file
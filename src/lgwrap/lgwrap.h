@@ -5,7 +5,32 @@
 // private libraries
 #include "utils/tools.h"
 #include "utils/settings.h"
+#include "utils/grid.h"
+#include "utils/pacer.h"
+#include "utils/jobs.h"
+#include "utils/triple.h"
+#include "utils/input.h"
+#include "utils/mapped.h"
+#include "utils/level.h"
+#include "utils/streamer.h"
+#include "utils/pool.h"
+#include "utils/arena.h"
+#include "utils/replay.h"
+#include "utils/memtrack.h"
+// the renderer needs GLAD, GLFW and FreeType, which headless builds (LGW_HEADLESS) don't have
+#ifndef LGW_HEADLESS
 #include "render/shader.h"
+#include "render/stream.h"
 #include "render/ftwrap.h"
+#include "render/culling.h"
+#include "render/chunk.h"
+#include "render/loader.h"
+#include "render/glstats.h"
+#include "render/profiler.h"
+#include "render/particles.h"
+#endif
 #include "physics/object.h"
-#include "physics/collision.h"
\ No newline at end of file
+#include "physics/collision.h"
+#include "physics/world.h"
+#include "physics/contact.h"
+#include "physics/counters.h"
\ No newline at end of file
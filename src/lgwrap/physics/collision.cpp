@@ -239,4 +239,10 @@ bool lgw::objectIntersectsBarrier(Object& obj, Barrier2D& bar)
 bool lgw::objectIntersectsObject(Object& obj1, Object& obj2)
 {
 	return objectIntersectsObject(obj1.p1, obj1.p2, obj2.p1, obj2.p2);
+}
+// return true if two boxes overlap (touching edges count as overlapping)
+bool lgw::boxIntersectsBox(const Box& box1, const Box& box2)
+{
+	return (box1.p1.x <= box2.p2.x && box2.p1.x <= box1.p2.x
+		&& box1.p1.y <= box2.p2.y && box2.p1.y <= box1.p2.y);
 }
\ No newline at end of file
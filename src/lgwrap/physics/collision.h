@@ -33,4 +33,7 @@ namespace lgw {
 	bool objectIntersectsBarrier(Object& obj, Barrier2D& bar);
 	// return true if a 2D object intersects with another 2D object
 	bool objectIntersectsObject(Object& obj1, Object& obj2);
+
+	// return true if two boxes overlap (touching edges count as overlapping)
+	bool boxIntersectsBox(const Box& box1, const Box& box2);
 }
\ No newline at end of file
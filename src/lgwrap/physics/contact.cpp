@@ -0,0 +1,62 @@
+#include "contact.h"
+
+#include <algorithm> // for std::sort
+
+// ContactBuffer: start a step
+void lgw::ContactBuffer::begin(void)
+{
+	previous.swap(current);
+	current.clear();
+}
+// ContactBuffer: report a contact found during the step
+void lgw::ContactBuffer::add(Entity a, Entity b, Vector normal, float impulse, bool sensor)
+{
+	current.push_back({ pairKey(a, b), { a, b, normal, impulse, ContactPhase::PERSIST, sensor } });
+}
+// ContactBuffer: turn the contacts of the step into events
+void lgw::ContactBuffer::finish(void)
+{
+	// sort by pair and merge the reports of the same pair (the substeps add their impulses, the last normal wins)
+	std::sort(current.begin(), current.end(), [](const Contact& x, const Contact& y) { return x.key < y.key; });
+	size_t merged = 0;
+	for (size_t i = 0; i < current.size(); i++)
+	{
+		if (merged > 0 && current[merged - 1].key == current[i].key)
+		{
+			ContactEvent& event = current[merged - 1].event;
+			event.impulse += current[i].event.impulse;
+			event.normal = current[i].event.normal;
+			event.sensor = event.sensor && current[i].event.sensor;
+			continue;
+		}
+		current[merged++] = current[i];
+	}
+	current.resize(merged);
+
+	// both lists are sorted, so one pass finds the pairs that are new, still touching or gone
+	eventBuffer.clear();
+	size_t i = 0, j = 0;
+	while (i < current.size() || j < previous.size())
+	{
+		if (j == previous.size() || (i < current.size() && current[i].key < previous[j].key))
+		{
+			eventBuffer.push_back(current[i].event);
+			eventBuffer.back().phase = ContactPhase::BEGIN;
+			i++;
+		}
+		else if (i == current.size() || previous[j].key < current[i].key)
+		{
+			eventBuffer.push_back(previous[j].event);
+			eventBuffer.back().phase = ContactPhase::END;
+			eventBuffer.back().impulse = 0.0f;
+			j++;
+		}
+		else
+		{
+			eventBuffer.push_back(current[i].event);
+			eventBuffer.back().phase = ContactPhase::PERSIST;
+			i++;
+			j++;
+		}
+	}
+}
\ No newline at end of file
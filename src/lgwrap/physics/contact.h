@@ -0,0 +1,53 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "object.h"
+#include "../utils/pool.h"
+
+namespace lgw {
+	// BEGIN: the pair touches for the first step, PERSIST: it touched during the last step too, END: it stopped touching
+	enum class ContactPhase : uint8_t { BEGIN, PERSIST, END };
+
+	// one contact between two entities during a step
+	struct ContactEvent {
+		// the entity that was pushed out and the one it touched
+		Entity a, b;
+		// direction 'a' was pushed in (points away from 'b')
+		Vector normal;
+		// velocity removed from 'a' along the normal, summed over the step's substeps (0 for END events)
+		float impulse;
+		ContactPhase phase;
+		// sensors report contacts without pushing anything out
+		bool sensor;
+	};
+
+	// contiguous buffer of the contact events of one simulation step
+	// (the physics code only adds the pairs it found; the events are worked out once the step is done, so gameplay code
+	// reads them in bulk afterwards, and since the buffer doesn't change until the next step it can be read by several
+	// jobs at once)
+	class ContactBuffer {
+	public:
+		// start a step (the contacts of the last step are kept to tell new contacts from old ones)
+		void begin(void);
+		// report a contact found during the step (a pair reported by several substeps is merged)
+		void add(Entity a, Entity b, Vector normal, float impulse, bool sensor = false);
+		// turn the contacts of the step into events
+		void finish(void);
+		// events of the last finished step (sorted by pair)
+		inline const std::vector<ContactEvent>& events(void) const { return eventBuffer; }
+		// number of pairs touching after the last finished step
+		inline size_t touching(void) const { return current.size(); }
+	private:
+		struct Contact {
+			uint64_t key;
+			ContactEvent event;
+		};
+		static inline uint64_t pairKey(Entity a, Entity b) { return ((uint64_t)a.id << 32) | b.id; }
+		// contacts of the current and the last step
+		std::vector<Contact> current;
+		std::vector<Contact> previous;
+		std::vector<ContactEvent> eventBuffer;
+	};
+}
\ No newline at end of file
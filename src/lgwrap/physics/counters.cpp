@@ -0,0 +1,18 @@
+#include "counters.h"
+
+// physics counters: write one JSON line
+void lgw::PhysicsCounters::writeJSON(std::ostream& out, long long step, int substeps) const
+{
+	out << "{\"step\":" << step
+		<< ",\"substeps\":" << substeps
+		<< ",\"bodies_integrated\":" << bodiesIntegrated
+		<< ",\"broadphase_pairs\":" << broadphasePairs
+		<< ",\"narrowphase_tests\":" << narrowphaseTests
+		<< ",\"hits\":" << hits
+		<< ",\"contacts_resolved\":" << contactsResolved
+		<< ",\"sleeping_bodies\":" << sleepingBodies
+		<< ",\"integrate_ms\":" << integrateTime * 1000.0
+		<< ",\"collide_ms\":" << collideTime * 1000.0
+		<< ",\"contacts_ms\":" << contactTime * 1000.0
+		<< ",\"total_ms\":" << totalTime() * 1000.0 << "}\n";
+}
\ No newline at end of file
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <ostream>
+
+namespace lgw {
+	// work done by the physics during one simulation step (summed over the step's substeps)
+	struct PhysicsCounters {
+		// bodies moved (the player counts as one)
+		int bodiesIntegrated = 0;
+		// body/edge pairs handed to the narrowphase (there's no spatial broadphase yet, so every moving body is paired
+		// with each edge of the world it can touch; a broadphase would shrink this number)
+		int broadphasePairs = 0;
+		// overlap tests the narrowphase ran (every pair handed to it is tested)
+		int narrowphaseTests = 0;
+		// tests that found an overlap and pushed the body out
+		int hits = 0;
+		// contact events the step produced for the gameplay code (merged over the substeps)
+		int contactsResolved = 0;
+		// bodies at rest after the step (no velocity while lying on the ground; they don't sleep yet, this is how many a
+		// sleep pass could skip)
+		int sleepingBodies = 0;
+		// time spent moving the bodies, testing and resolving overlaps, and turning the contacts into events (seconds)
+		double integrateTime = 0.0;
+		double collideTime = 0.0;
+		double contactTime = 0.0;
+		// total time of the three phases
+		inline double totalTime(void) const { return integrateTime + collideTime + contactTime; }
+		// start counting a new step
+		inline void reset(void) { *this = PhysicsCounters(); }
+		// write the counters as one JSON object on its own line (with the step they belong to)
+		void writeJSON(std::ostream& out, long long step, int substeps) const;
+	};
+}
\ No newline at end of file
@@ -1,7 +1,7 @@
 #include "object.h"
 
 // Barrier1D: translate the object's position in the virtual world to coordinates on the window
-void lgw::Barrier1D::setVertices(float xShift = 0.0f, float yShift = 0.0f)
+void lgw::Barrier1D::setVertices(float windowAspectRatio, float inverseScaleFactor, float xShift, float yShift)
 {
 	vertices[0] = (2 * (p1.x) / (windowAspectRatio * inverseScaleFactor)) - 1.0f + xShift;
 	vertices[1] = (2 * (p1.y) / inverseScaleFactor) - 1.0f + yShift;
@@ -9,14 +9,10 @@ void lgw::Barrier1D::setVertices(float xShift = 0.0f, float yShift = 0.0f)
 	vertices[3] = (2 * (p2.y) / inverseScaleFactor) - 1.0f + yShift;
 }
 // Barrier1D: constructor
-lgw::Barrier1D::Barrier1D(float& windowAspectRatio, float& inverseScaleFactor, Point p1, Point p2)
-	: windowAspectRatio(windowAspectRatio), inverseScaleFactor(inverseScaleFactor), p1(p1), p2(p2)
-{
-	setVertices();
-}
+lgw::Barrier1D::Barrier1D(Point p1, Point p2) : p1(p1), p2(p2) {}
 
 // Barrier2D: translate the object's position in the virtual world to coordinates on the window
-void lgw::Barrier2D::setVertices(float xShift = 0.0f, float yShift = 0.0f)
+void lgw::Barrier2D::setVertices(float windowAspectRatio, float inverseScaleFactor, float xShift, float yShift)
 {
 	vertices[0] = (2 * (p1.x) / (windowAspectRatio * inverseScaleFactor)) - 1.0f + xShift;
 	vertices[1] = (2 * (p1.y) / inverseScaleFactor) - 1.0f + yShift;
@@ -28,14 +24,10 @@ void lgw::Barrier2D::setVertices(float xShift = 0.0f, float yShift = 0.0f)
 	vertices[7] = vertices[1];
 }
 // Barrier2D: constructor
-lgw::Barrier2D::Barrier2D(float& windowAspectRatio, float& inverseScaleFactor, Point p1, Point p2)
-	: windowAspectRatio(windowAspectRatio), inverseScaleFactor(inverseScaleFactor), p1(p1), p2(p2)
-{
-	setVertices();
-}
+lgw::Barrier2D::Barrier2D(Point p1, Point p2) : p1(p1), p2(p2) {}
 
 // Texture: translate the object's position in the virtual world to coordinates on the window
-void lgw::Texture::setVertices(float xShift = 0.0f, float yShift = 0.0f)
+void lgw::Texture::setVertices(float windowAspectRatio, float inverseScaleFactor, float xShift, float yShift)
 {
 	vertices[0] = (2 * (p1.x) / (windowAspectRatio * inverseScaleFactor)) - 1.0f + xShift;
 	vertices[1] = (2 * (p1.y) / inverseScaleFactor) - 1.0f + yShift;
@@ -58,14 +50,10 @@ void lgw::Texture::setVertices(float xShift = 0.0f, float yShift = 0.0f)
 	vertices[15] = difference.y;
 }
 // Texture: constructor
-lgw::Texture::Texture(float& windowAspectRatio, float& inverseScaleFactor, Point p1, Point p2)
-	: windowAspectRatio(windowAspectRatio), inverseScaleFactor(inverseScaleFactor), p1(p1), p2(p2)
-{
-	setVertices();
-}
+lgw::Texture::Texture(Point p1, Point p2) : p1(p1), p2(p2) {}
 
 // Object: translate the object's position in the virtual world to coordinates on the window
-void lgw::Object::setVertices(float xShift = 0.0f, float yShift = 0.0f)
+void lgw::Object::setVertices(float windowAspectRatio, float inverseScaleFactor, float xShift, float yShift)
 {
 	vertices[0] = (2 * (p1.x) / (windowAspectRatio * inverseScaleFactor)) - 1.0f + xShift;
 	vertices[1] = (2 * (p1.y) / inverseScaleFactor) - 1.0f + yShift;
@@ -77,11 +65,7 @@ void lgw::Object::setVertices(float xShift = 0.0f, float yShift = 0.0f)
 	vertices[7] = vertices[1];
 }
 // Object: constructor
-lgw::Object::Object(float& windowAspectRatio, float& inverseScaleFactor, Point p1, Point p2)
-	: windowAspectRatio(windowAspectRatio), inverseScaleFactor(inverseScaleFactor), p1(p1), p2(p2), prev_p1(p1), prev_p2(p2)
-{
-	setVertices();
-}
+lgw::Object::Object(Point p1, Point p2) : p1(p1), p2(p2), prev_p1(p1), prev_p2(p2) {}
 // Object: calculate the object's next position and velocity after one timestep
 void lgw::Object::calcTimeStep(float timeElapsed, float accelerationX = 0.0f, float accelerationY = 0.0f)
 {
@@ -19,6 +19,17 @@ namespace lgw {
 	// create alias 'Vector' for 'Point'
 	typedef Point Vector;
 
+	// axis-aligned box (p1 is always the lower-left corner and p2 the upper-right corner)
+	class Box {
+	public:
+		// corner positions
+		Point p1, p2;
+		// constructors
+		inline Box() {}
+		inline Box(Point a, Point b)
+			: p1(std::fmin(a.x, b.x), std::fmin(a.y, b.y)), p2(std::fmax(a.x, b.x), std::fmax(a.y, b.y)) {}
+	};
+
 	// static 1D object
 	class Barrier1D {
 	public:
@@ -26,12 +37,9 @@ namespace lgw {
 		Point p1, p2;
 		float vertices[4] = { 0.0f };
 		// translate the object's position in the virtual world to coordinates on the window
-		void setVertices(float xShift, float yShift);
+		void setVertices(float windowAspectRatio, float inverseScaleFactor, float xShift, float yShift);
 		// constructor
-		Barrier1D(float& windowAspectRatio, float& inverseScaleFactor, Point p1, Point p2);
-	private:
-		float& windowAspectRatio;
-		float& inverseScaleFactor;
+		Barrier1D(Point p1, Point p2);
 	};
 
 	// static 2D object
@@ -41,12 +49,9 @@ namespace lgw {
 		Point p1, p2;
 		float vertices[8] = { 0.0f };
 		// translate the object's position in the virtual world to coordinates on the window
-		void setVertices(float xShift, float yShift);
+		void setVertices(float windowAspectRatio, float inverseScaleFactor, float xShift, float yShift);
 		// constructor
-		Barrier2D(float& windowAspectRatio, float& inverseScaleFactor, Point p1, Point p2);
-	private:
-		float& windowAspectRatio;
-		float& inverseScaleFactor;
+		Barrier2D(Point p1, Point p2);
 	};
 
 	// texture object (static 2D object that has a texture)
@@ -56,12 +61,9 @@ namespace lgw {
 		Point p1, p2;
 		float vertices[16] = { 0.0f };
 		// translate the object's position in the virtual world to coordinates on the window
-		void setVertices(float xShift, float yShift);
+		void setVertices(float windowAspectRatio, float inverseScaleFactor, float xShift, float yShift);
 		// constructor
-		Texture(float& windowAspectRatio, float& inverseScaleFactor, Point p1, Point p2);
-	private:
-		float& windowAspectRatio;
-		float& inverseScaleFactor;
+		Texture(Point p1, Point p2);
 	};
 
 	// dynamic object
@@ -73,13 +75,10 @@ namespace lgw {
 		Vector velocity;
 		float vertices[8] = { 0.0f };
 		// translate the object's position in the virtual world to coordinates on the window
-		void setVertices(float xShift, float yShift);
+		void setVertices(float windowAspectRatio, float inverseScaleFactor, float xShift, float yShift);
 		// constructor
-		Object(float& windowAspectRatio, float& inverseScaleFactor, Point p1, Point p2);
+		Object(Point p1, Point p2);
 		// calculate the object's next position and velocity after one timestep
 		void calcTimeStep(float timeElapsed, float accelerationX, float accelerationY);
-	private:
-		float& windowAspectRatio;
-		float& inverseScaleFactor;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,71 @@
+#include "world.h"
+
+// World: constructor
+lgw::World::World(uint32_t capacity) : entities(capacity)
+{
+	transforms.reserve(capacity);
+	bodies.reserve(capacity);
+	rects.reserve(capacity);
+	colors.reserve(capacity);
+}
+// World: create an entity without components
+lgw::Entity lgw::World::spawn(void)
+{
+	return entities.create();
+}
+// World: create a body at the given corners
+lgw::Entity lgw::World::spawnBody(Point p1, Point p2, const Color& color, Vector velocity)
+{
+	Entity entity = entities.create();
+	if (entity == Entity())
+		return entity;
+	transforms.add(entity, { p1, p2, p1, p2 });
+	bodies.add(entity, { velocity });
+	rects.add(entity, { Box(p1, p2) });
+	colors.add(entity, color);
+	return entity;
+}
+// World: remove an entity and all of its components
+bool lgw::World::despawn(Entity entity)
+{
+	if (!entities.alive(entity))
+		return false;
+	transforms.remove(entity);
+	bodies.remove(entity);
+	rects.remove(entity);
+	colors.remove(entity);
+	return entities.destroy(entity);
+}
+// World: advance every body by one timestep
+void lgw::World::integrate(float timeElapsed, float accelerationX, float accelerationY)
+{
+	float xAccel = (accelerationX * (timeElapsed * timeElapsed)) / 2;
+	float yAccel = (accelerationY * (timeElapsed * timeElapsed)) / 2;
+	for (uint32_t i = 0; i < bodies.size(); i++)
+	{
+		Transform* transform = transforms.get(bodies.owner(i));
+		if (transform == nullptr)
+			continue;
+		Vector& velocity = bodies[i].velocity;
+		transform->prev_p1 = transform->p1;
+		transform->prev_p2 = transform->p2;
+		float xShift = (velocity.x * timeElapsed) + xAccel;
+		float yShift = (velocity.y * timeElapsed) + yAccel;
+		transform->p1.x += xShift;
+		transform->p2.x += xShift;
+		transform->p1.y += yShift;
+		transform->p2.y += yShift;
+		velocity.x += accelerationX * timeElapsed;
+		velocity.y += accelerationY * timeElapsed;
+	}
+}
+// World: copy the transforms into the render rects
+void lgw::World::updateRects(void)
+{
+	for (uint32_t i = 0; i < rects.size(); i++)
+	{
+		const Transform* transform = transforms.get(rects.owner(i));
+		if (transform != nullptr)
+			rects[i].box = Box(transform->p1, transform->p2);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "object.h"
+#include "../utils/pool.h"
+
+// constants
+namespace lgwcon {
+	// entities a world makes room for up front (more can be spawned, but the first spawns beyond this allocate)
+	const uint32_t WORLD_CAPACITY = 16384;
+}
+
+namespace lgw {
+	// position of an entity (and its position before the last step)
+	struct Transform {
+		Point p1, p2;
+		Point prev_p1, prev_p2;
+	};
+	// entity that moves under the world's gravity
+	struct Body {
+		Vector velocity;
+	};
+	// world-space rectangle an entity is drawn as
+	struct RenderRect {
+		Box box;
+	};
+	// color an entity is drawn with (RGBA)
+	struct Color {
+		float rgba[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+	};
+
+	// pooled entity store (entities are handles from the pool, their components live in dense arrays)
+	class World {
+	public:
+		EntityPool entities;
+		ComponentArray<Transform> transforms;
+		ComponentArray<Body> bodies;
+		ComponentArray<RenderRect> rects;
+		ComponentArray<Color> colors;
+		// constructor (makes room for 'capacity' entities, so spawning up to that many never allocates)
+		World(uint32_t capacity = lgwcon::WORLD_CAPACITY);
+		// create an entity without components
+		Entity spawn(void);
+		// create a body at the given corners (with a transform, a body, a render rect and a color)
+		Entity spawnBody(Point p1, Point p2, const Color& color, Vector velocity = Vector());
+		// remove an entity and all of its components (returns false if the handle was already invalid)
+		bool despawn(Entity entity);
+		// return true if the handle refers to a living entity
+		inline bool alive(Entity entity) const { return entities.alive(entity); }
+		// advance every body by one timestep (same motion as Object::calcTimeStep)
+		void integrate(float timeElapsed, float accelerationX, float accelerationY);
+		// copy the transforms into the render rects
+		void updateRects(void);
+	};
+}
\ No newline at end of file
@@ -0,0 +1,230 @@
+#include "chunk.h"
+
+#include <algorithm> // for std::find, std::sort and std::unique
+
+// chunk renderer: constructor
+lgw::ChunkRenderer::ChunkRenderer(float tileSize) : tileSize(tileSize), grid(tileSize * lgwcon::CHUNK_SIZE) {}
+// chunk renderer: destructor
+lgw::ChunkRenderer::~ChunkRenderer(void)
+{
+    for (std::pair<const long long, Chunk>& entry : chunks)
+    {
+        glDeleteVertexArrays(1, &entry.second.VAO);
+        glDeleteBuffers(1, &entry.second.VBO);
+    }
+}
+// chunk renderer: return the chunk at the given chunk coordinates
+lgw::ChunkRenderer::Chunk& lgw::ChunkRenderer::getChunk(int x, int y)
+{
+    Chunk& chunk = chunks[chunkKey(x, y)];
+    if (chunk.gridID == -1)
+    {
+        chunk.x = x;
+        chunk.y = y;
+        chunk.tiles.assign(lgwcon::CHUNK_SIZE * lgwcon::CHUNK_SIZE * 4, 0.0f);
+        chunk.bounds = Box(
+            Point(x * lgwcon::CHUNK_SIZE * tileSize, y * lgwcon::CHUNK_SIZE * tileSize),
+            Point((x + 1) * lgwcon::CHUNK_SIZE * tileSize, (y + 1) * lgwcon::CHUNK_SIZE * tileSize));
+        chunk.gridID = grid.insert(chunk.bounds);
+        if (chunk.gridID >= (int)gridChunks.size())
+            gridChunks.resize(chunk.gridID + 1, nullptr);
+        gridChunks[chunk.gridID] = &chunk;
+    }
+    return chunk;
+}
+// chunk renderer: queue a chunk for rebaking
+void lgw::ChunkRenderer::markDirty(Chunk& chunk)
+{
+    if (chunk.dirty)
+        return;
+    chunk.dirty = true;
+    dirtyChunks.push_back(&chunk);
+}
+// chunk renderer: recompute the world-space bounds of a chunk
+void lgw::ChunkRenderer::updateBounds(Chunk& chunk)
+{
+    // the tile area of the chunk plus every rectangle that sticks out of it
+    Box bounds(
+        Point(chunk.x * lgwcon::CHUNK_SIZE * tileSize, chunk.y * lgwcon::CHUNK_SIZE * tileSize),
+        Point((chunk.x + 1) * lgwcon::CHUNK_SIZE * tileSize, (chunk.y + 1) * lgwcon::CHUNK_SIZE * tileSize));
+    for (size_t i = 0; i < chunk.rects.size(); i += 8)
+    {
+        bounds.p1.x = std::fmin(bounds.p1.x, chunk.rects[i]);
+        bounds.p1.y = std::fmin(bounds.p1.y, chunk.rects[i + 1]);
+        bounds.p2.x = std::fmax(bounds.p2.x, chunk.rects[i + 2]);
+        bounds.p2.y = std::fmax(bounds.p2.y, chunk.rects[i + 3]);
+    }
+    chunk.bounds = bounds;
+    grid.update(chunk.gridID, bounds);
+}
+// chunk renderer: set the color of a tile
+void lgw::ChunkRenderer::setTile(int x, int y, const float color[4])
+{
+    Chunk& chunk = getChunk(floorDiv(x, lgwcon::CHUNK_SIZE), floorDiv(y, lgwcon::CHUNK_SIZE));
+    int localX = x - chunk.x * lgwcon::CHUNK_SIZE;
+    int localY = y - chunk.y * lgwcon::CHUNK_SIZE;
+    float* tile = &chunk.tiles[(localY * lgwcon::CHUNK_SIZE + localX) * 4];
+    for (int i = 0; i < 4; i++)
+        tile[i] = color[i];
+    markDirty(chunk);
+}
+// chunk renderer: remove a tile
+void lgw::ChunkRenderer::clearTile(int x, int y)
+{
+    std::unordered_map<long long, Chunk>::iterator entry = chunks.find(chunkKey(floorDiv(x, lgwcon::CHUNK_SIZE), floorDiv(y, lgwcon::CHUNK_SIZE)));
+    if (entry == chunks.end())
+        return;
+    Chunk& chunk = entry->second;
+    int localX = x - chunk.x * lgwcon::CHUNK_SIZE;
+    int localY = y - chunk.y * lgwcon::CHUNK_SIZE;
+    chunk.tiles[(localY * lgwcon::CHUNK_SIZE + localX) * 4 + 3] = 0.0f;
+    markDirty(chunk);
+}
+// chunk renderer: add a static rectangle
+void lgw::ChunkRenderer::addRect(Point p1, Point p2, const float color[4])
+{
+    Box box(p1, p2);
+    Chunk& chunk = getChunk(
+        (int)std::floor(box.p1.x / (lgwcon::CHUNK_SIZE * tileSize)),
+        (int)std::floor(box.p1.y / (lgwcon::CHUNK_SIZE * tileSize)));
+    float rect[8] = { box.p1.x, box.p1.y, box.p2.x, box.p2.y, color[0], color[1], color[2], color[3] };
+    chunk.rects.insert(chunk.rects.end(), rect, rect + 8);
+    updateBounds(chunk);
+    markDirty(chunk);
+}
+// chunk renderer: add every rectangle of a level section
+void lgw::ChunkRenderer::addRects(const LevelRects& rects)
+{
+    std::vector<Chunk*> touched;
+    for (uint32_t i = 0; i < rects.count; i++)
+    {
+        Box box(Point(rects.x1[i], rects.y1[i]), Point(rects.x2[i], rects.y2[i]));
+        Chunk& chunk = getChunk(
+            (int)std::floor(box.p1.x / (lgwcon::CHUNK_SIZE * tileSize)),
+            (int)std::floor(box.p1.y / (lgwcon::CHUNK_SIZE * tileSize)));
+        float rect[8] = { box.p1.x, box.p1.y, box.p2.x, box.p2.y };
+        rects.unpackColor(i, rect + 4);
+        chunk.rects.insert(chunk.rects.end(), rect, rect + 8);
+        // every chunk this call adds to gets its bounds updated, including ones that were already dirty
+        if (touched.empty() || touched.back() != &chunk)
+            touched.push_back(&chunk);
+        markDirty(chunk);
+    }
+    std::sort(touched.begin(), touched.end());
+    touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+    for (Chunk* chunk : touched)
+        updateBounds(*chunk);
+}
+// chunk renderer: remove a chunk with everything in it
+void lgw::ChunkRenderer::removeChunk(int x, int y)
+{
+    std::unordered_map<long long, Chunk>::iterator entry = chunks.find(chunkKey(x, y));
+    if (entry == chunks.end())
+        return;
+    Chunk& chunk = entry->second;
+    if (chunk.dirty)
+        dirtyChunks.erase(std::find(dirtyChunks.begin(), dirtyChunks.end(), &chunk));
+    glDeleteVertexArrays(1, &chunk.VAO);
+    glDeleteBuffers(1, &chunk.VBO);
+    grid.remove(chunk.gridID);
+    gridChunks[chunk.gridID] = nullptr;
+    chunks.erase(entry);
+}
+// chunk renderer: append a quad to a bake buffer
+void lgw::ChunkRenderer::bakeQuad(std::vector<float>& buffer, float x1, float y1, float x2, float y2, const float color[4])
+{
+    const float corners[6][2] = {
+        { x1, y1 }, { x1, y2 }, { x2, y2 },
+        { x1, y1 }, { x2, y2 }, { x2, y1 }
+    };
+    for (int i = 0; i < 6; i++)
+    {
+        buffer.push_back(corners[i][0]);
+        buffer.push_back(corners[i][1]);
+        buffer.insert(buffer.end(), color, color + 4);
+    }
+}
+// chunk renderer: build the vertices of a chunk
+void lgw::ChunkRenderer::buildChunk(const Chunk& chunk, std::vector<float>& buffer) const
+{
+    buffer.clear();
+    float originX = chunk.x * lgwcon::CHUNK_SIZE * tileSize;
+    float originY = chunk.y * lgwcon::CHUNK_SIZE * tileSize;
+    for (int y = 0; y < lgwcon::CHUNK_SIZE; y++)
+    {
+        for (int x = 0; x < lgwcon::CHUNK_SIZE; x++)
+        {
+            const float* tile = &chunk.tiles[(y * lgwcon::CHUNK_SIZE + x) * 4];
+            if (tile[3] <= 0.0f)
+                continue;
+            bakeQuad(buffer, originX + x * tileSize, originY + y * tileSize, originX + (x + 1) * tileSize, originY + (y + 1) * tileSize, tile);
+        }
+    }
+    for (size_t i = 0; i < chunk.rects.size(); i += 8)
+        bakeQuad(buffer, chunk.rects[i], chunk.rects[i + 1], chunk.rects[i + 2], chunk.rects[i + 3], &chunk.rects[i + 4]);
+}
+// chunk renderer: upload the vertices of a chunk into its vertex buffer
+void lgw::ChunkRenderer::uploadChunk(Chunk& chunk, const std::vector<float>& buffer)
+{
+    if (chunk.VAO == 0)
+    {
+        glGenVertexArrays(1, &chunk.VAO);
+        glBindVertexArray(chunk.VAO);
+        glGenBuffers(1, &chunk.VBO);
+        glBindBuffer(GL_ARRAY_BUFFER, chunk.VBO);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, lgwcon::CHUNK_VERTEX_SIZE * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, lgwcon::CHUNK_VERTEX_SIZE * sizeof(float), (void*)(2 * sizeof(float)));
+        glEnableVertexAttribArray(1);
+    }
+    else
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, chunk.VBO);
+    }
+    glBufferData(GL_ARRAY_BUFFER, buffer.size() * sizeof(float), buffer.data(), GL_STATIC_DRAW);
+    chunk.vertexCount = (int)buffer.size() / lgwcon::CHUNK_VERTEX_SIZE;
+    chunk.dirty = false;
+}
+// chunk renderer: rebake every chunk that changed since the last call
+void lgw::ChunkRenderer::bake(JobSystem* jobs)
+{
+    if (dirtyChunks.empty())
+        return;
+    if (bakeBuffers.size() < dirtyChunks.size())
+        bakeBuffers.resize(dirtyChunks.size());
+    std::function<void(int, int)> build = [this](int begin, int end) {
+        for (int i = begin; i < end; i++)
+            buildChunk(*dirtyChunks[i], bakeBuffers[i]);
+    };
+    if (jobs)
+        jobs->parallelFor((int)dirtyChunks.size(), 1, build);
+    else
+        build(0, (int)dirtyChunks.size());
+    for (size_t i = 0; i < dirtyChunks.size(); i++)
+        uploadChunk(*dirtyChunks[i], bakeBuffers[i]);
+    dirtyChunks.clear();
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+// chunk renderer: draw every chunk that overlaps the view
+void lgw::ChunkRenderer::render(Shader* shader, const Box& view, float windowAspectRatio, float inverseScaleFactor, float xShift, float yShift)
+{
+    visibleIDs.clear();
+    grid.query(view, visibleIDs);
+    drawn = 0;
+    if (visibleIDs.empty())
+        return;
+
+    shader->use();
+    glUniform4f(shader->uniLoc("view"), 2.0f / (windowAspectRatio * inverseScaleFactor), 2.0f / inverseScaleFactor, xShift, yShift);
+    for (int id : visibleIDs)
+    {
+        Chunk& chunk = *gridChunks[id];
+        if (chunk.vertexCount == 0)
+            continue;
+        glBindVertexArray(chunk.VAO);
+        glDrawArrays(GL_TRIANGLES, 0, chunk.vertexCount);
+        drawn++;
+    }
+    glBindVertexArray(0);
+}
\ No newline at end of file
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+
+// public (external) libraries
+#include <glad/glad.h> // loader for OpenGL
+
+// private libraries
+#include "../physics/object.h"
+#include "../utils/grid.h"
+#include "../utils/jobs.h"
+#include "../utils/level.h"
+#include "shader.h"
+
+// constants
+namespace lgwcon {
+    // number of tiles along each side of a chunk
+    const int CHUNK_SIZE = 32;
+    // floats per baked vertex (vec2 position, vec4 color)
+    const int CHUNK_VERTEX_SIZE = 6;
+}
+
+namespace lgw {
+    // renders static level geometry that is split into fixed-size world chunks
+    // (each chunk is baked into its own vertex buffer and drawn with a single call)
+    class ChunkRenderer {
+    private:
+        struct Chunk {
+            // chunk coordinates
+            int x, y;
+            // tile colors (alpha of 0 means the tile is empty)
+            std::vector<float> tiles;
+            // static rectangles whose lower-left corner lies in this chunk { x1, y1, x2, y2, r, g, b, a }
+            std::vector<float> rects;
+            // world-space bounds of everything in the chunk
+            Box bounds;
+            // ID of the bounds in the spatial grid
+            int gridID = -1;
+            // baked geometry
+            GLuint VAO = 0, VBO = 0;
+            int vertexCount = 0;
+            // true if the chunk changed since it was last baked
+            bool dirty = false;
+        };
+        // size of a tile in the virtual world
+        float tileSize;
+        // all chunks that contain at least one tile or rectangle
+        std::unordered_map<long long, Chunk> chunks;
+        // spatial index of chunk bounds
+        SpatialGrid grid;
+        // chunks that changed since the last bake
+        std::vector<Chunk*> dirtyChunks;
+        // chunks returned by the last visibility query
+        std::vector<int> visibleIDs;
+        // chunk stored under each spatial grid ID
+        std::vector<Chunk*> gridChunks;
+        // number of chunks drawn by the last call to render
+        int drawn = 0;
+        // temporary vertex storage used while baking (one per dirty chunk so they can be built in parallel)
+        std::vector<std::vector<float>> bakeBuffers;
+        // return the chunk at the given chunk coordinates (created if it doesn't exist yet)
+        Chunk& getChunk(int x, int y);
+        // queue a chunk for rebaking
+        void markDirty(Chunk& chunk);
+        // recompute the world-space bounds of a chunk
+        void updateBounds(Chunk& chunk);
+        // append a quad to a bake buffer
+        static void bakeQuad(std::vector<float>& buffer, float x1, float y1, float x2, float y2, const float color[4]);
+        // build the vertices of a chunk (doesn't touch GL, so it can run on any thread)
+        void buildChunk(const Chunk& chunk, std::vector<float>& buffer) const;
+        // upload the vertices of a chunk into its vertex buffer
+        void uploadChunk(Chunk& chunk, const std::vector<float>& buffer);
+        static inline long long chunkKey(int x, int y) { return ((long long)x << 32) | (unsigned int)y; }
+        static inline int floorDiv(int a, int b) { return (a >= 0) ? a / b : -((-a + b - 1) / b); }
+    public:
+        // constructor
+        ChunkRenderer(float tileSize = 1.0f);
+        // destructor
+        ~ChunkRenderer(void);
+        // set the color of a tile (tile coordinates are world positions divided by the tile size)
+        void setTile(int x, int y, const float color[4]);
+        // remove a tile
+        void clearTile(int x, int y);
+        // add a static rectangle (e.g. the corners of a Barrier2D or Texture)
+        void addRect(Point p1, Point p2, const float color[4]);
+        // add every rectangle of a level section (the bounds of each chunk are only recomputed once)
+        void addRects(const LevelRects& rects);
+        // remove a chunk with everything in it (e.g. when a streamed level chunk is evicted)
+        void removeChunk(int x, int y);
+        // rebake every chunk that changed since the last call (needs a current GL context; with a job system the
+        // vertices of the chunks are built in parallel and only the uploads happen on the calling thread)
+        void bake(JobSystem* jobs = nullptr);
+        // draw every chunk that overlaps the view with one draw call each
+        void render(Shader* shader, const Box& view, float windowAspectRatio, float inverseScaleFactor, float xShift, float yShift);
+        // number of chunks
+        inline int chunkCount(void) const { return (int)chunks.size(); }
+        // number of chunks drawn by the last call to render
+        inline int drawnCount(void) const { return drawn; }
+    };
+}
\ No newline at end of file
@@ -0,0 +1,45 @@
+#include "culling.h"
+
+// world-space area that is visible through the camera
+lgw::Box lgw::viewBox(float windowAspectRatio, float inverseScaleFactor, float xShift, float yShift)
+{
+    // setVertices maps x to (2x / (aspect * scale)) - 1 + shift, so solve for the world positions at -1 and 1
+    float width = windowAspectRatio * inverseScaleFactor / 2.0f;
+    float height = inverseScaleFactor / 2.0f;
+    return Box(
+        Point(-xShift * width, -yShift * height),
+        Point((2.0f - xShift) * width, (2.0f - yShift) * height));
+}
+
+// culler: constructor
+lgw::Culler::Culler(float cellSize) : grid(cellSize) {}
+// culler: register a drawable and return its ID
+int lgw::Culler::add(Point p1, Point p2)
+{
+    int id = grid.insert(Box(p1, p2));
+    if (id >= (int)visibleFlags.size())
+        visibleFlags.resize(id + 1, false);
+    visibleFlags[id] = false;
+    return id;
+}
+// culler: move a registered drawable
+void lgw::Culler::move(int id, Point p1, Point p2)
+{
+    grid.update(id, Box(p1, p2));
+}
+// culler: unregister a drawable
+void lgw::Culler::remove(int id)
+{
+    grid.remove(id);
+    visibleFlags[id] = false;
+}
+// culler: recompute the set of visible drawables
+void lgw::Culler::update(const Box& view)
+{
+    for (int id : visibleIDs)
+        visibleFlags[id] = false;
+    visibleIDs.clear();
+    grid.query(view, visibleIDs);
+    for (int id : visibleIDs)
+        visibleFlags[id] = true;
+}
\ No newline at end of file
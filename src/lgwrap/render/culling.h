@@ -0,0 +1,40 @@
+#pragma once
+
+#include <vector>
+
+// private libraries
+#include "../physics/object.h"
+#include "../utils/grid.h"
+
+namespace lgw {
+    // world-space area that is visible through the camera (the inverse of the transform in 'setVertices')
+    Box viewBox(float windowAspectRatio, float inverseScaleFactor, float xShift, float yShift);
+
+    // visibility pass: tracks the world-space bounds of every drawable and finds the ones that overlap the view
+    class Culler {
+    private:
+        // spatial index of all drawable bounds
+        SpatialGrid grid;
+        // visibility of every drawable after the last update
+        std::vector<bool> visibleFlags;
+        // IDs returned by the last query
+        std::vector<int> visibleIDs;
+    public:
+        // constructor
+        Culler(float cellSize = 4.0f);
+        // register a drawable by its world-space corners and return its ID
+        int add(Point p1, Point p2);
+        // move a drawable that was registered before
+        void move(int id, Point p1, Point p2);
+        // unregister a drawable
+        void remove(int id);
+        // recompute the set of visible drawables
+        void update(const Box& view);
+        // return true if the drawable overlapped the view during the last update
+        inline bool visible(int id) const { return visibleFlags[id]; }
+        // number of visible drawables after the last update
+        inline int visibleCount(void) const { return (int)visibleIDs.size(); }
+        // number of registered drawables
+        inline int totalCount(void) const { return grid.size(); }
+    };
+}
\ No newline at end of file
@@ -1,11 +1,42 @@
 #include "ftwrap.h"
 
+#include <cstring> // for std::memcpy and std::memcmp
+#include <fstream> // for writing the atlas cache
+#include <sstream> // for naming the atlas cache
+#include <iomanip> // for naming the atlas cache
+#include <algorithm> // for std::max
+
+// private libraries
+#include "../utils/mapped.h" // for MappedFile, hashBytes and createDirectory
+
+namespace {
+    // header of a font atlas cache file (followed by one FontCacheGlyph per character and the atlas pixels)
+    struct FontCacheHeader {
+        char magic[4];
+        unsigned int version;
+        unsigned long long fontHash;
+        unsigned int pixelSize;
+        unsigned int glyphCount;
+        unsigned int atlasWidth;
+        unsigned int atlasHeight;
+    };
+    // glyph metrics in a font atlas cache file (FT_Pos has a different size on Windows and Linux)
+    struct FontCacheGlyph {
+        float size[2];
+        float bearing[2];
+        float uv[4];
+        int advance;
+    };
+}
+
 // output freetype errors
 FT_Error lgw::ftwrapHandleError(FT_Error error)
 {
     if (error != FT_Err_Ok)
     {
-        std::cout << "FreeType: " << FT_Error_String(error) << std::endl;
+        // FT_Error_String returns null when FreeType is built without error strings (printing null would silence std::cout)
+        const char* message = FT_Error_String(error);
+        std::cout << "FreeType: " << (message != nullptr ? message : "error " + std::to_string(error)) << std::endl;
         return error;
     }
     else
@@ -15,62 +46,241 @@ FT_Error lgw::ftwrapHandleError(FT_Error error)
 }
 
 // font object: constructor
-lgw::Font::Font(FontLibrary& library, const char* fontDir, int numChars) : lib(library), dir(fontDir), charSetLength(numChars)
+lgw::Font::Font(FontLibrary& library, const char* fontDir, int numChars, int pixels) : lib(library), dir(fontDir), charSetLength(numChars), pixelSize(pixels)
 {
-    charSet = new CharSet[charSetLength]{ 0 };
+    charSet = new CharSet[charSetLength]();
 }
-// load font
-int lgw::Font::load(void)
+// font object: destructor
+lgw::Font::~Font(void)
 {
+    delete[] charSet;
+    if (atlas != 0)
+        glDeleteTextures(1, &atlas);
+}
+// font object: rasterize every glyph and pack them into the atlas pixels
+int lgw::Font::rasterize(void)
+{
+    FT_Error error = lib.init();
+    if (error)
+        return error;
     FT_Face face;
-    FT_Error error = ftwrapHandleError(FT_New_Face(lib.id, dir, 0, &face));
+    error = ftwrapHandleError(FT_New_Face(lib.id, dir, 0, &face));
     if (error)
         return error;
 
-    FT_Set_Pixel_Sizes(face, 0, 30);
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // disable byte-alignment restriction
+    FT_Set_Pixel_Sizes(face, 0, pixelSize);
 
-    for (unsigned char i = 0; i < charSetLength; i++)
+    // rasterize the glyphs and pack them into rows from left to right (with a pixel of space so linear filtering
+    // doesn't bleed between neighbors)
+    std::vector<std::vector<unsigned char>> bitmaps(charSetLength);
+    std::vector<glm::ivec2> positions(charSetLength);
+    int x = 1, y = 1, rowHeight = 0;
+    for (int i = 0; i < charSetLength; i++)
     {
         // load character glyph
         error = ftwrapHandleError(FT_Load_Char(face, i, FT_LOAD_RENDER));
         if (error)
+        {
+            FT_Done_Face(face);
             return error;
-        // generate texture
-        unsigned int texture;
-        glGenTextures(1, &texture);
-        glBindTexture(GL_TEXTURE_2D, texture);
-        glTexImage2D(
-            GL_TEXTURE_2D,
-            0,
-            GL_RED,
-            face->glyph->bitmap.width,
-            face->glyph->bitmap.rows,
-            0,
-            GL_RED,
-            GL_UNSIGNED_BYTE,
-            face->glyph->bitmap.buffer
-        );
-        // set texture options
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        // store character for later use
+        }
+        const FT_Bitmap& bitmap = face->glyph->bitmap;
+        int width = (int)bitmap.width, rows = (int)bitmap.rows;
+        if (x + width + 1 > lgwcon::FONT_ATLAS_WIDTH)
+        {
+            x = 1;
+            y += rowHeight + 1;
+            rowHeight = 0;
+        }
+        positions[i] = glm::ivec2(x, y);
+        bitmaps[i].resize((size_t)width * rows);
+        for (int row = 0; row < rows; row++)
+            std::memcpy(&bitmaps[i][(size_t)row * width], bitmap.buffer + row * bitmap.pitch, width);
+        x += width + 1;
+        rowHeight = std::max(rowHeight, rows);
+        // store character for later use (the atlas coordinates are filled in once the atlas size is known)
         charSet[i] = {
-            texture,
             glm::vec2(face->glyph->bitmap.width, face->glyph->bitmap.rows),
             glm::vec2(face->glyph->bitmap_left, face->glyph->bitmap_top),
-            face->glyph->advance.x
+            face->glyph->advance.x,
+            glm::vec4(0.0f)
         };
     }
-    // destroy 'face' after the textures are created and glyph data is moved to 'charSet'
+    // destroy 'face' after the glyph data is moved to 'charSet'
     FT_Done_Face(face);
 
+    atlasWidth = lgwcon::FONT_ATLAS_WIDTH;
+    atlasHeight = y + rowHeight + 1;
+    atlasPixels.assign((size_t)atlasWidth * atlasHeight, 0);
+    for (int i = 0; i < charSetLength; i++)
+    {
+        int width = (int)charSet[i].size.x, rows = (int)charSet[i].size.y;
+        for (int row = 0; row < rows; row++)
+            std::memcpy(&atlasPixels[(size_t)(positions[i].y + row) * atlasWidth + positions[i].x], &bitmaps[i][(size_t)row * width], width);
+        charSet[i].uv = glm::vec4(
+            (float)positions[i].x / atlasWidth, (float)positions[i].y / atlasHeight,
+            (float)(positions[i].x + width) / atlasWidth, (float)(positions[i].y + rows) / atlasHeight);
+    }
+    return 0;
+}
+// font object: hash of the font file
+int lgw::Font::hashFont(unsigned long long& hash) const
+{
+    MappedFile file;
+    if (file.open(dir))
+        return -1;
+    hash = hashBytes(file.data(), file.size());
+    return 0;
+}
+// font object: cache file for a font hash
+std::string lgw::Font::cachePath(const std::string& cacheDir, unsigned long long hash) const
+{
+    std::stringstream name;
+    name << cacheDir << "font_" << std::hex << std::setw(16) << std::setfill('0') << hash << std::dec << "_" << pixelSize << ".bin";
+    return name.str();
+}
+// font object: read the glyph metrics from a cache file
+int lgw::Font::readCache(const std::string& path, unsigned long long hash)
+{
+    MappedFile& file = cacheFile;
+    if (file.open(path) || file.size() < sizeof(FontCacheHeader))
+    {
+        file.close();
+        return -1;
+    }
+    const FontCacheHeader* header = reinterpret_cast<const FontCacheHeader*>(file.data());
+    size_t expected = sizeof(FontCacheHeader) + sizeof(FontCacheGlyph) * header->glyphCount + (size_t)header->atlasWidth * header->atlasHeight;
+    if (std::memcmp(header->magic, lgwcon::FONT_CACHE_MAGIC, 4) != 0 || header->version != lgwcon::FONT_CACHE_VERSION
+        || header->fontHash != hash || header->pixelSize != (unsigned int)pixelSize || header->glyphCount != (unsigned int)charSetLength
+        || file.size() != expected)
+    {
+        file.close();
+        return -1;
+    }
+    const FontCacheGlyph* glyphs = reinterpret_cast<const FontCacheGlyph*>(file.data() + sizeof(FontCacheHeader));
+    for (int i = 0; i < charSetLength; i++)
+    {
+        charSet[i] = {
+            glm::vec2(glyphs[i].size[0], glyphs[i].size[1]),
+            glm::vec2(glyphs[i].bearing[0], glyphs[i].bearing[1]),
+            (FT_Pos)glyphs[i].advance,
+            glm::vec4(glyphs[i].uv[0], glyphs[i].uv[1], glyphs[i].uv[2], glyphs[i].uv[3])
+        };
+    }
+    atlasWidth = (int)header->atlasWidth;
+    atlasHeight = (int)header->atlasHeight;
+    // the pixels are uploaded straight from the mapped file
+    cachedPixels = file.data() + sizeof(FontCacheHeader) + sizeof(FontCacheGlyph) * header->glyphCount;
+    return 0;
+}
+// font object: write the glyph metrics and the atlas pixels to a cache file
+int lgw::Font::writeCache(const std::string& path, unsigned long long hash) const
+{
+    FontCacheHeader header;
+    std::memcpy(header.magic, lgwcon::FONT_CACHE_MAGIC, 4);
+    header.version = lgwcon::FONT_CACHE_VERSION;
+    header.fontHash = hash;
+    header.pixelSize = (unsigned int)pixelSize;
+    header.glyphCount = (unsigned int)charSetLength;
+    header.atlasWidth = (unsigned int)atlasWidth;
+    header.atlasHeight = (unsigned int)atlasHeight;
+    std::vector<FontCacheGlyph> glyphs(charSetLength);
+    for (int i = 0; i < charSetLength; i++)
+    {
+        glyphs[i] = {
+            { charSet[i].size.x, charSet[i].size.y },
+            { charSet[i].bearing.x, charSet[i].bearing.y },
+            { charSet[i].uv.x, charSet[i].uv.y, charSet[i].uv.z, charSet[i].uv.w },
+            (int)charSet[i].advance
+        };
+    }
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(glyphs.data()), sizeof(FontCacheGlyph) * glyphs.size());
+    file.write(reinterpret_cast<const char*>(atlasPixels.data()), atlasPixels.size());
+    if (!file)
+    {
+        std::cout << "FreeType: failed to write " << path << std::endl;
+        return -1;
+    }
+    return 0;
+}
+// font object: create the atlas texture
+void lgw::Font::upload(const unsigned char* pixels)
+{
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // disable byte-alignment restriction
+    glGenTextures(1, &atlas);
+    glBindTexture(GL_TEXTURE_2D, atlas);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, atlasWidth, atlasHeight, 0, GL_RED, GL_UNSIGNED_BYTE, pixels);
+    // set texture options
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+// load font
+int lgw::Font::load(const std::string& cacheDir)
+{
+    int error = prepare(cacheDir);
+    if (error)
+        return error;
+    create();
+    return 0;
+}
+// read or rasterize the atlas
+int lgw::Font::prepare(const std::string& cacheDir)
+{
+    unsigned long long hash = 0;
+    bool cached = !cacheDir.empty() && hashFont(hash) == 0;
+    if (cached && readCache(cachePath(cacheDir, hash), hash) == 0)
+        return 0;
+
+    int error = rasterize();
+    if (error)
+        return error;
+    if (cached && createDirectory(cacheDir) == 0)
+        writeCache(cachePath(cacheDir, hash), hash);
+    return 0;
+}
+// upload the atlas
+void lgw::Font::create(void)
+{
+    if (cachedPixels != nullptr)
+    {
+        upload(cachedPixels);
+        cachedPixels = nullptr;
+        cacheFile.close();
+    }
+    else if (!atlasPixels.empty())
+    {
+        upload(atlasPixels.data());
+        atlasPixels.clear();
+        atlasPixels.shrink_to_fit();
+    }
+}
+// rasterize the font and write it to the cache
+int lgw::Font::bake(const std::string& cacheDir)
+{
+    unsigned long long hash = 0;
+    if (hashFont(hash))
+    {
+        std::cout << "FreeType: failed to open " << dir << std::endl;
+        return -1;
+    }
+    int error = rasterize();
+    if (error)
+        return error;
+    std::string path = cachePath(cacheDir, hash);
+    if (createDirectory(cacheDir) || writeCache(path, hash))
+        return -1;
+    std::cout << "FreeType: wrote " << path << " (" << atlasWidth << "x" << atlasHeight << " atlas)" << std::endl;
+    atlasPixels.clear();
+    atlasPixels.shrink_to_fit();
     return 0;
 }
 // initialize rendering
-void lgw::Font::startRender(GLuint& VAO, GLuint& VBO, Shader* shader, int windowWidth, int windowHeight)
+void lgw::Font::startRender(GLuint& VAO, StreamBuffer& buffer, Shader* shader, int windowWidth, int windowHeight)
 {
     shader->use();
     glDisable(GL_DEPTH_TEST);
@@ -80,61 +290,79 @@ void lgw::Font::startRender(GLuint& VAO, GLuint& VBO, Shader* shader, int window
     glm::mat4 projection = glm::ortho(0.0f, (float)windowWidth, 0.0f, (float)windowHeight);
     glUniformMatrix4fv(shader->uniLoc("projection"), 1, GL_FALSE, glm::value_ptr(projection));
     glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, atlas);
     glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    stream = &buffer;
 }
 // render a string of text
-void lgw::Font::render(Shader* shader, std::string text, float xPos, float yPos, float scale, glm::vec3 color)
+void lgw::Font::render(Shader* shader, StringView text, float xPos, float yPos, float scale, glm::vec3 color)
 {
     // set color
     glUniform3f(shader->uniLoc("textColor"), color.x, color.y, color.z);
 
+    if (text.empty())
+        return;
+
+    // write the quads of the whole string into the stream buffer with a single map
+    GLintptr offset;
+    float* vertices = (float*)stream->map(text.size() * sizeof(float) * 24, sizeof(float) * 4, offset);
+    if (vertices == nullptr)
+        return;
+
     // temporary variables
     float x, y, w, h;
+    int glyphCount = 0;
 
-    for (int i = 0; i < text.length(); i++)
+    for (size_t i = 0; i < text.size(); i++)
     {
+        // characters outside of the character set aren't drawn
+        unsigned char c = (unsigned char)text[i];
+        if (c >= charSetLength)
+            continue;
+
         // new line
-        if (text[i] == 10)
+        if (c == 10)
         {
-            yPos += (charSet[text[i]].bearing.y / 64) * scale; // bitshift by 6 to get value in pixels (2^6 = 64)
+            yPos += (charSet[c].bearing.y / 64) * scale; // bitshift by 6 to get value in pixels (2^6 = 64)
             continue;
         }
 
         // determine x and y position on the window
-        x = xPos + charSet[text[i]].bearing.x * scale;
-        y = yPos - (charSet[text[i]].size.y - charSet[text[i]].bearing.y) * scale;
+        x = xPos + charSet[c].bearing.x * scale;
+        y = yPos - (charSet[c].size.y - charSet[c].bearing.y) * scale;
 
         // determine width and height
-        w = charSet[text[i]].size.x * scale;
-        h = charSet[text[i]].size.y * scale;
+        w = charSet[c].size.x * scale;
+        h = charSet[c].size.y * scale;
 
-        float vertices[6][4] = {
-            { x,     y + h,   0.0f, 0.0f },
-            { x,     y,       0.0f, 1.0f },
-            { x + w, y,       1.0f, 1.0f },
+        const glm::vec4& uv = charSet[c].uv;
+        float quad[6][4] = {
+            { x,     y + h,   uv.x, uv.y },
+            { x,     y,       uv.x, uv.w },
+            { x + w, y,       uv.z, uv.w },
 
-            { x,     y + h,   0.0f, 0.0f },
-            { x + w, y,       1.0f, 1.0f },
-            { x + w, y + h,   1.0f, 0.0f }
+            { x,     y + h,   uv.x, uv.y },
+            { x + w, y,       uv.z, uv.w },
+            { x + w, y + h,   uv.z, uv.y }
         };
+        std::memcpy(vertices + glyphCount * 24, quad, sizeof(quad));
+        glyphCount++;
 
-        // render glyph texture over quad
-        glBindTexture(GL_TEXTURE_2D, charSet[text[i]].textureID);
-        // update content of VBO memory
-        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
-        // render quad
-        glDrawArrays(GL_TRIANGLES, 0, 6);
         // now advance cursors for next glyph (note that advance is number of 1/64 pixels)
-        xPos += (charSet[text[i]].advance >> 6) * scale; // bitshift by 6 to get value in pixels (2^6 = 64)
+        xPos += (charSet[c].advance >> 6) * scale; // bitshift by 6 to get value in pixels (2^6 = 64)
     }
+    stream->unmap();
+
+    // every glyph comes from the atlas, so the whole string is one draw
+    if (glyphCount > 0)
+        glDrawArrays(GL_TRIANGLES, (GLint)(offset / (sizeof(float) * 4)), glyphCount * 6);
 }
-// (optional) unbinds the VAO, VBO, and the texture
+// (optional) unbinds the VAO and the texture
 void lgw::Font::stopRender(void)
 {
     glDisable(GL_CULL_FACE);
     glDisable(GL_BLEND);
     glBindVertexArray(0);
     glBindTexture(GL_TEXTURE_2D, 0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    stream = nullptr;
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include <iostream> // for debug
 #include <string> // for when const char* won't work
+#include <vector>
 
 // public (external) libraries
 #include <glad/glad.h> // loader for OpenGL
@@ -11,12 +12,27 @@
 // OpenGL math
 #include <glm/vec2.hpp> // glm::vec2
 #include <glm/vec3.hpp> // glm::vec3
+#include <glm/vec4.hpp> // glm::vec4
 #include <glm/mat4x4.hpp> // glm::mat4
 #include <glm/gtc/type_ptr.hpp>
 
 // private libraries
 #include "../physics/object.h"
 #include "shader.h"
+#include "stream.h"
+#include "../utils/mapped.h"
+#include "../utils/arena.h"
+
+// constants
+namespace lgwcon {
+    // height that glyphs are rasterized at in pixels
+    const int FONT_PIXEL_SIZE = 30;
+    // width of the glyph atlas in pixels
+    const int FONT_ATLAS_WIDTH = 512;
+    // font atlas cache
+    const char FONT_CACHE_MAGIC[4] = { 'L', 'G', 'W', 'F' };
+    const unsigned int FONT_CACHE_VERSION = 1;
+}
 
 namespace lgw {
     // output freetype errors
@@ -34,40 +50,73 @@ namespace lgw {
         {
             FT_Done_FreeType(id_);
         }
-        // init FreeType library
+        // init FreeType library (does nothing if it's already initialized)
         inline FT_Error init(void)
         {
+            if (id_ != 0)
+                return 0;
             return ftwrapHandleError(FT_Init_FreeType(&id_));
         }
     };
 
     // font object
+    // (all glyphs are packed into one atlas texture, so a string is drawn with a single call; the atlas and the glyph
+    // metrics can be cached in a file keyed by a hash of the font file and the pixel size, and a font loaded from that
+    // file never touches FreeType)
     class Font {
     private:
         FontLibrary& lib;
         const char* dir;
         int charSetLength;
+        int pixelSize;
         struct CharSet {
-            FT_UInt textureID; // ID handle of the glyph texture
             glm::vec2 size; // size of glyph
             glm::vec2 bearing; // offset from baseline to left/top of glyph
             FT_Pos advance; // offset to advance to next glyph
+            glm::vec4 uv; // corners of the glyph in the atlas (u1, v1, u2, v2; v1 is the top row)
         } *charSet;
+        // glyph atlas (red channel only)
+        GLuint atlas = 0;
+        int atlasWidth = 0;
+        int atlasHeight = 0;
+        // atlas pixels between rasterizing and uploading them
+        std::vector<unsigned char> atlasPixels;
+        // cache file the atlas pixels come from between reading and uploading them
+        MappedFile cacheFile;
+        const unsigned char* cachedPixels = nullptr;
+        // buffer that glyph quads are streamed through (set by startRender)
+        StreamBuffer* stream = nullptr;
+        // rasterize every glyph with FreeType and pack them into the atlas pixels
+        int rasterize(void);
+        // hash of the font file (returns -1 if it can't be read) and the cache file for it
+        int hashFont(unsigned long long& hash) const;
+        std::string cachePath(const std::string& cacheDir, unsigned long long hash) const;
+        // read the glyph metrics from a cache file and keep it mapped for the upload (returns -1 if it's missing or
+        // doesn't match)
+        int readCache(const std::string& path, unsigned long long hash);
+        // write the glyph metrics and the atlas pixels to a cache file
+        int writeCache(const std::string& path, unsigned long long hash) const;
+        // create the atlas texture
+        void upload(const unsigned char* pixels);
     public:
         // constructor
-        Font(FontLibrary& library, const char* fontDir, int numChars);
+        Font(FontLibrary& library, const char* fontDir, int numChars, int pixels = lgwcon::FONT_PIXEL_SIZE);
         // destructor
-        inline ~Font(void)
-        {
-            delete[] charSet;
-        }
-        // load font
-        int load(void);
+        ~Font(void);
+        // load font (with a cache directory the atlas is read from the cache, and only rasterized with FreeType and
+        // written to the cache if it isn't there yet)
+        int load(const std::string& cacheDir = std::string());
+        // the two halves of load: prepare reads or rasterizes the atlas without touching GL (so it can run on a worker
+        // thread while the window is created) and create uploads it
+        int prepare(const std::string& cacheDir = std::string());
+        void create(void);
+        // rasterize the font and write it to the cache without creating a texture (doesn't need a GL context)
+        int bake(const std::string& cacheDir);
         // initialize rendering
-        void startRender(GLuint& VAO, GLuint& VBO, Shader* shader, int windowWidth, int windowHeight);
+        void startRender(GLuint& VAO, StreamBuffer& buffer, Shader* shader, int windowWidth, int windowHeight);
         // render a string of text
-        void render(Shader* shader, std::string text, float xPos, float yPos, float scale, glm::vec3 color);
-        // (optional) unbinds the VAO, VBO, and the texture
+        void render(Shader* shader, StringView text, float xPos, float yPos, float scale, glm::vec3 color);
+        // (optional) unbinds the VAO and the texture
         void stopRender(void);
     };
 }
\ No newline at end of file
@@ -0,0 +1,87 @@
+#include "glstats.h"
+
+lgw::GLCallStats lgw::glCallStats;
+
+namespace {
+    // wraps one glad function pointer: the wrapper bumps the counters and forwards to the driver's function
+    template <typename Function, Function* Slot>
+    struct GLHook;
+    template <typename R, typename... Args, R (APIENTRYP* Slot)(Args...)>
+    struct GLHook<R (APIENTRYP)(Args...), Slot> {
+        static R (APIENTRYP real)(Args...);
+        static long long lgw::GLCallStats::* category;
+        static R APIENTRY call(Args... args)
+        {
+            lgw::glCallStats.total++;
+            if (category)
+                lgw::glCallStats.*category += 1;
+            return real(args...);
+        }
+        static void install(long long lgw::GLCallStats::* countAs)
+        {
+            // functions the driver doesn't provide stay null
+            if (*Slot == nullptr || *Slot == &call)
+                return;
+            real = *Slot;
+            category = countAs;
+            *Slot = &call;
+        }
+    };
+    template <typename R, typename... Args, R (APIENTRYP* Slot)(Args...)>
+    R (APIENTRYP GLHook<R (APIENTRYP)(Args...), Slot>::real)(Args...) = nullptr;
+    template <typename R, typename... Args, R (APIENTRYP* Slot)(Args...)>
+    long long lgw::GLCallStats::* GLHook<R (APIENTRYP)(Args...), Slot>::category = nullptr;
+}
+
+// hook a glad function pointer and count its calls in the given category (or only in the total)
+#define LGW_HOOK_GL(function, countAs) GLHook<decltype(glad_##function), &glad_##function>::install(countAs)
+
+// replace glad's function pointers with counting wrappers
+void lgw::installGLCallCounters(void)
+{
+    // draws
+    LGW_HOOK_GL(glDrawArrays, &GLCallStats::draws);
+    LGW_HOOK_GL(glDrawElements, &GLCallStats::draws);
+    LGW_HOOK_GL(glDrawElementsBaseVertex, &GLCallStats::draws);
+    LGW_HOOK_GL(glDrawArraysInstanced, &GLCallStats::draws);
+    LGW_HOOK_GL(glDrawElementsInstanced, &GLCallStats::draws);
+    LGW_HOOK_GL(glMultiDrawArrays, &GLCallStats::draws);
+    // uploads
+    LGW_HOOK_GL(glBufferData, &GLCallStats::uploads);
+    LGW_HOOK_GL(glBufferSubData, &GLCallStats::uploads);
+    LGW_HOOK_GL(glMapBufferRange, &GLCallStats::uploads);
+    LGW_HOOK_GL(glTexImage2D, &GLCallStats::uploads);
+    LGW_HOOK_GL(glTexSubImage2D, &GLCallStats::uploads);
+    // uniforms
+    LGW_HOOK_GL(glUniform1i, &GLCallStats::uniforms);
+    LGW_HOOK_GL(glUniform1f, &GLCallStats::uniforms);
+    LGW_HOOK_GL(glUniform3f, &GLCallStats::uniforms);
+    LGW_HOOK_GL(glUniform4f, &GLCallStats::uniforms);
+    LGW_HOOK_GL(glUniformMatrix4fv, &GLCallStats::uniforms);
+    LGW_HOOK_GL(glGetUniformLocation, &GLCallStats::uniforms);
+    // binds
+    LGW_HOOK_GL(glBindVertexArray, &GLCallStats::binds);
+    LGW_HOOK_GL(glBindBuffer, &GLCallStats::binds);
+    LGW_HOOK_GL(glBindTexture, &GLCallStats::binds);
+    LGW_HOOK_GL(glBindFramebuffer, &GLCallStats::binds);
+    LGW_HOOK_GL(glUseProgram, &GLCallStats::binds);
+    // everything else that shows up in a frame
+    LGW_HOOK_GL(glUnmapBuffer, nullptr);
+    LGW_HOOK_GL(glActiveTexture, nullptr);
+    LGW_HOOK_GL(glEnable, nullptr);
+    LGW_HOOK_GL(glDisable, nullptr);
+    LGW_HOOK_GL(glBlendFunc, nullptr);
+    LGW_HOOK_GL(glPolygonMode, nullptr);
+    LGW_HOOK_GL(glClear, nullptr);
+    LGW_HOOK_GL(glClearColor, nullptr);
+    LGW_HOOK_GL(glViewport, nullptr);
+    LGW_HOOK_GL(glPixelStorei, nullptr);
+    LGW_HOOK_GL(glVertexAttribPointer, nullptr);
+    LGW_HOOK_GL(glEnableVertexAttribArray, nullptr);
+    LGW_HOOK_GL(glFenceSync, nullptr);
+    LGW_HOOK_GL(glClientWaitSync, nullptr);
+    LGW_HOOK_GL(glDeleteSync, nullptr);
+    LGW_HOOK_GL(glBeginQuery, nullptr);
+    LGW_HOOK_GL(glEndQuery, nullptr);
+    LGW_HOOK_GL(glGetQueryObjectui64v, nullptr);
+}
\ No newline at end of file
@@ -0,0 +1,21 @@
+#pragma once
+
+// public (external) libraries
+#include <glad/glad.h> // loader for OpenGL
+
+namespace lgw {
+    // number of OpenGL calls made since the last reset (only counted after installGLCallCounters)
+    struct GLCallStats {
+        long long total = 0; // every hooked call
+        long long draws = 0; // glDraw*
+        long long uploads = 0; // glBufferData, glBufferSubData, glMapBufferRange, glTexImage2D, ...
+        long long uniforms = 0; // glUniform*
+        long long binds = 0; // glBind*, glUseProgram
+    };
+    extern GLCallStats glCallStats;
+
+    // replace glad's function pointers with counting wrappers (call once after gladLoadGLLoader)
+    void installGLCallCounters(void);
+    // reset the counters
+    inline void resetGLCallStats(void) { glCallStats = GLCallStats(); }
+}
\ No newline at end of file
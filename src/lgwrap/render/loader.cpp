@@ -0,0 +1,205 @@
+#include "loader.h"
+
+#include <cstring> // for std::memcpy
+
+// image decoder (only decodes from memory, the files are read with the standard library)
+#define STB_IMAGE_IMPLEMENTATION
+#define STBI_NO_STDIO
+#include <stb/stb_image.h>
+
+// decode an image file
+int lgw::loadImage(const std::string& dir, Image& image)
+{
+    // read the whole file
+    std::ifstream file(dir, std::ios::binary);
+    if (!file.is_open())
+        return lgwcon::IMAGE_LOAD_FAILED;
+    std::vector<unsigned char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    file.close();
+
+    // decode with 4 channels whatever the file stores, so every texture is uploaded as RGBA8 through the PBOs
+    int width, height, channels;
+    unsigned char* decoded = stbi_load_from_memory(data.data(), (int)data.size(), &width, &height, &channels, 4);
+    if (decoded == nullptr)
+        return lgwcon::IMAGE_FORMAT_UNSUPPORTED;
+    image.width = width;
+    image.height = height;
+    size_t rowSize = (size_t)width * 4;
+    image.pixels.resize(rowSize * height);
+
+    // stb_image returns the top row first but OpenGL expects the bottom row first
+    for (int y = 0; y < height; y++)
+        std::memcpy(image.pixels.data() + (height - 1 - y) * rowSize, decoded + y * rowSize, rowSize);
+    stbi_image_free(decoded);
+    return 0;
+}
+
+// texture loader: constructor
+lgw::TextureLoader::TextureLoader(const std::string& assetDirectory) : assetDir(assetDirectory) {}
+// texture loader: destructor
+lgw::TextureLoader::~TextureLoader(void)
+{
+    // decode jobs still write into this loader
+    if (jobs)
+        jobs->wait(decoding);
+    for (Entry& entry : entries)
+        glDeleteTextures(1, &entry.id);
+    glDeleteBuffers(lgwcon::TEXTURE_PBO_COUNT, PBOs);
+}
+// texture loader: create the pixel buffer objects and decode images on the given job system
+void lgw::TextureLoader::init(JobSystem& jobSystem)
+{
+    glGenBuffers(lgwcon::TEXTURE_PBO_COUNT, PBOs);
+    jobs = &jobSystem;
+}
+// texture loader: request a texture and return its handle
+int lgw::TextureLoader::acquire(const std::string& path)
+{
+    // already cached (or on its way)
+    std::unordered_map<std::string, int>::iterator cached = handles.find(path);
+    if (cached != handles.end())
+    {
+        entries[cached->second].refs++;
+        return cached->second;
+    }
+
+    int handle;
+    if (!freeHandles.empty())
+    {
+        handle = freeHandles.back();
+        freeHandles.pop_back();
+    }
+    else
+    {
+        handle = (int)entries.size();
+        entries.emplace_back();
+    }
+    Entry& entry = entries[handle];
+    entry.path = path;
+    entry.refs = 1;
+    entry.id = 0;
+    entry.state = State::LOADING;
+    entry.serial++;
+    entry.image = Image();
+    handles[path] = handle;
+    loading++;
+    unsigned int serial = entry.serial;
+    std::string dir = assetDir + path;
+    jobs->submit([this, handle, serial, dir] {
+        Result result = { handle, serial, 0, Image() };
+        result.error = loadImage(dir, result.image);
+        std::lock_guard<std::mutex> lock(resultMutex);
+        results.push_back(std::move(result));
+    }, &decoding);
+    return handle;
+}
+// texture loader: give up a handle returned by acquire
+void lgw::TextureLoader::release(int handle)
+{
+    Entry& entry = entries[handle];
+    if (--entry.refs > 0)
+        return;
+    destroy(handle);
+}
+// texture loader: free the cache slot of an entry
+void lgw::TextureLoader::destroy(int handle)
+{
+    Entry& entry = entries[handle];
+    if (entry.state == State::LOADING || entry.state == State::DECODED)
+        loading--;
+    glDeleteTextures(1, &entry.id);
+    handles.erase(entry.path);
+    entry.id = 0;
+    entry.path.clear();
+    entry.image = Image();
+    // results that are still on their way for this slot are dropped because the serial changes
+    entry.serial++;
+    freeHandles.push_back(handle);
+}
+// texture loader: copy a decoded image into a PBO and create the texture from it
+void lgw::TextureLoader::upload(Entry& entry)
+{
+    GLsizeiptr size = (GLsizeiptr)entry.image.pixels.size();
+    GLuint PBO = PBOs[nextPBO];
+    nextPBO = (nextPBO + 1) % lgwcon::TEXTURE_PBO_COUNT;
+
+    // orphan the previous storage so the driver never waits for an earlier upload from this PBO to finish
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, PBO);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+    void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    if (mapped)
+    {
+        std::memcpy(mapped, entry.image.pixels.data(), size);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    }
+
+    glGenTextures(1, &entry.id);
+    glBindTexture(GL_TEXTURE_2D, entry.id);
+    if (mapped)
+    {
+        // with a PBO bound the last argument is an offset into it and the copy happens asynchronously
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, entry.image.width, entry.image.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, (const void*)0);
+    }
+    else
+    {
+        // mapping failed; fall back to a direct upload from client memory
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, entry.image.width, entry.image.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, entry.image.pixels.data());
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    // the pixels live on the GPU now; keep only the size
+    std::vector<unsigned char>().swap(entry.image.pixels);
+    entry.state = State::READY;
+    loading--;
+}
+// texture loader: collect decoded images and upload them, up to the per-frame budget
+void lgw::TextureLoader::update(int byteBudget)
+{
+    // collect finished decodes
+    std::vector<Result> finished;
+    {
+        std::lock_guard<std::mutex> lock(resultMutex);
+        finished.swap(results);
+    }
+    for (Result& result : finished)
+    {
+        Entry& entry = entries[result.handle];
+        if (entry.serial != result.serial || entry.state != State::LOADING)
+            continue; // released before the decode finished
+        if (result.error)
+        {
+            std::cout << "texture: failed to load " << assetDir << entry.path << std::endl;
+            entry.state = State::FAILED;
+            loading--;
+            continue;
+        }
+        entry.image = std::move(result.image);
+        entry.state = State::DECODED;
+        uploadQueue.push_back({ result.handle, result.serial });
+    }
+
+    // upload as many images as the budget allows (at least one per frame so large images still get through)
+    int uploaded = 0;
+    while (!uploadQueue.empty())
+    {
+        std::pair<int, unsigned int> next = uploadQueue.front();
+        Entry& entry = entries[next.first];
+        if (entry.serial != next.second || entry.state != State::DECODED)
+        {
+            uploadQueue.pop_front();
+            continue;
+        }
+        int size = (int)entry.image.pixels.size();
+        if (uploaded > 0 && uploaded + size > byteBudget)
+            break;
+        uploadQueue.pop_front();
+        upload(entry);
+        uploaded += size;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <iostream> // for debug
+#include <fstream> // for reading image files
+#include <string> // for when const char* won't work
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <mutex>
+
+// public (external) libraries
+#include <glad/glad.h> // loader for OpenGL
+
+// private libraries
+#include "../utils/jobs.h"
+
+// constants
+namespace lgwcon {
+    // general constants
+    const int TEXTURE_PBO_COUNT = 3;
+    const int TEXTURE_UPLOAD_BUDGET = 4 * 1024 * 1024; // bytes uploaded per frame
+    // error codes
+    const int IMAGE_LOAD_FAILED = 1;
+    const int IMAGE_FORMAT_UNSUPPORTED = 2;
+}
+
+namespace lgw {
+    // decoded image (8-bit RGBA, bottom row first)
+    struct Image {
+        int width = 0;
+        int height = 0;
+        std::vector<unsigned char> pixels;
+    };
+    // decode an image file with stb_image (PNG, JPG, BMP, TGA, ...; always converted to RGBA)
+    int loadImage(const std::string& dir, Image& image);
+
+    // loads textures from the asset directory: images are decoded by the job system and uploaded through pixel buffer objects
+    // (textures are cached by path and reference counted, so a path that is requested twice is only loaded once)
+    class TextureLoader {
+    private:
+        enum class State { LOADING, DECODED, READY, FAILED };
+        struct Entry {
+            std::string path;
+            int refs = 0;
+            GLuint id = 0;
+            State state = State::LOADING;
+            // incremented whenever the slot is reused so late decode results can be recognized
+            unsigned int serial = 0;
+            Image image;
+        };
+        struct Result {
+            int handle;
+            unsigned int serial;
+            int error;
+            Image image;
+        };
+        // asset directory
+        std::string assetDir;
+        // cache
+        std::vector<Entry> entries;
+        std::vector<int> freeHandles;
+        std::unordered_map<std::string, int> handles;
+        // decoded images waiting to be uploaded { handle, serial }
+        std::deque<std::pair<int, unsigned int>> uploadQueue;
+        // pixel buffer objects used for uploads (used round robin)
+        GLuint PBOs[lgwcon::TEXTURE_PBO_COUNT] = { 0 };
+        int nextPBO = 0;
+        // number of cached textures that aren't ready yet
+        int loading = 0;
+        // job system that decodes the images
+        JobSystem* jobs = nullptr;
+        // decode jobs that haven't finished yet
+        JobCounter decoding;
+        // finished decodes waiting to be collected by update
+        std::mutex resultMutex;
+        std::vector<Result> results;
+        // copy a decoded image into a PBO and create the texture from it
+        void upload(Entry& entry);
+        // free the cache slot of an entry
+        void destroy(int handle);
+    public:
+        // constructor
+        TextureLoader(const std::string& assetDirectory);
+        // destructor
+        ~TextureLoader(void);
+        // create the pixel buffer objects and decode images on the given job system (needs a current GL context)
+        void init(JobSystem& jobSystem);
+        // request a texture by its path relative to the asset directory and return its handle
+        int acquire(const std::string& path);
+        // give up a handle returned by acquire (the texture is deleted once nobody holds it)
+        void release(int handle);
+        // collect decoded images and upload them, up to the per-frame budget (call once per frame on the GL thread)
+        void update(int byteBudget = lgwcon::TEXTURE_UPLOAD_BUDGET);
+        // return true once the texture can be used
+        inline bool ready(int handle) const { return entries[handle].state == State::READY; }
+        // return true if the texture could not be loaded
+        inline bool failed(int handle) const { return entries[handle].state == State::FAILED; }
+        // GL texture ID (0 until the texture is ready)
+        inline GLuint id(int handle) const { return entries[handle].id; }
+        // size of a texture in pixels
+        inline int width(int handle) const { return entries[handle].image.width; }
+        inline int height(int handle) const { return entries[handle].image.height; }
+        // number of textures in the cache and the number that are still loading
+        inline int count(void) const { return (int)handles.size(); }
+        inline int pending(void) const { return loading; }
+    };
+}
\ No newline at end of file
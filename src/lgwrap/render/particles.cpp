@@ -0,0 +1,256 @@
+#include "particles.h"
+
+#include <algorithm> // for std::min and std::max
+#include <cstring> // for std::memset
+
+// SSE2 is part of every x64 CPU; other targets use the scalar loop
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define LGW_PARTICLES_SSE
+#include <emmintrin.h>
+#endif
+
+namespace {
+    // pack an RGBA color into 8 bits per channel (red in the lowest byte)
+    inline uint32_t packColor(const float color[4])
+    {
+        uint32_t packed = 0;
+        for (int i = 0; i < 4; i++)
+        {
+            float channel = std::min(std::max(color[i], 0.0f), 1.0f);
+            packed |= (uint32_t)(channel * 255.0f + 0.5f) << (8 * i);
+        }
+        return packed;
+    }
+}
+
+// ParticleSystem: constructor
+lgw::ParticleSystem::ParticleSystem(int capacity) : maxParticles(capacity)
+{
+    // the padding lanes are zeroed, so the SIMD loop can run over them without reading garbage
+    int padded = (capacity + 3) & ~3;
+    float** fields[] = { &x, &y, &vx, &vy, &age, &life, &bounce };
+    for (float** field : fields)
+    {
+        *field = new float[padded];
+        std::memset(*field, 0, sizeof(float) * padded);
+    }
+    startColor = new uint32_t[padded];
+    endColor = new uint32_t[padded];
+}
+// ParticleSystem: destructor
+lgw::ParticleSystem::~ParticleSystem(void)
+{
+    delete[] x;
+    delete[] y;
+    delete[] vx;
+    delete[] vy;
+    delete[] age;
+    delete[] life;
+    delete[] bounce;
+    delete[] startColor;
+    delete[] endColor;
+    glDeleteVertexArrays(1, &VAO);
+}
+// ParticleSystem: create the vertex array that reads particle vertices from the stream buffer
+void lgw::ParticleSystem::init(const StreamBuffer& buffer)
+{
+    glGenVertexArrays(1, &VAO);
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer.id);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, lgwcon::PARTICLE_VERTEX_SIZE, (void*)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, lgwcon::PARTICLE_VERTEX_SIZE, (void*)(2 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+// ParticleSystem: add an emitter
+int lgw::ParticleSystem::addEmitter(const ParticleEmitter& emitter)
+{
+    int id;
+    if (freeEmitters.empty())
+    {
+        id = (int)emitters.size();
+        emitters.emplace_back();
+    }
+    else
+    {
+        id = freeEmitters.back();
+        freeEmitters.pop_back();
+    }
+    emitters[id].settings = emitter;
+    emitters[id].accumulator = 0.0f;
+    emitters[id].used = true;
+    return id;
+}
+// ParticleSystem: remove an emitter
+void lgw::ParticleSystem::removeEmitter(int id)
+{
+    if (id < 0 || id >= (int)emitters.size() || !emitters[id].used)
+        return;
+    emitters[id].used = false;
+    freeEmitters.push_back(id);
+}
+// ParticleSystem: random number between -1 and 1
+float lgw::ParticleSystem::random(void)
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return (float)(seed >> 8) * (2.0f / 16777216.0f) - 1.0f;
+}
+// ParticleSystem: spawn particles from an emitter
+void lgw::ParticleSystem::spawn(const ParticleEmitter& emitter, int count)
+{
+    count = std::min(count, maxParticles - alive);
+    uint32_t start = packColor(emitter.startColor);
+    uint32_t end = packColor(emitter.endColor);
+    for (int i = alive; i < alive + count; i++)
+    {
+        x[i] = emitter.position.x;
+        y[i] = emitter.position.y;
+        vx[i] = emitter.velocity.x + emitter.velocityJitter.x * random();
+        vy[i] = emitter.velocity.y + emitter.velocityJitter.y * random();
+        age[i] = 0.0f;
+        life[i] = std::max(emitter.lifetime + emitter.lifetimeJitter * random(), 0.001f);
+        bounce[i] = emitter.collide ? emitter.bounce : -1.0f;
+        startColor[i] = start;
+        endColor[i] = end;
+    }
+    alive += std::max(count, 0);
+}
+// ParticleSystem: spawn particles at once
+void lgw::ParticleSystem::burst(const ParticleEmitter& emitter, int count)
+{
+    spawn(emitter, count);
+}
+// ParticleSystem: spawn from the emitters, move every particle and remove the dead ones
+void lgw::ParticleSystem::update(float timeElapsed)
+{
+    for (EmitterSlot& slot : emitters)
+    {
+        if (!slot.used || !slot.settings.active)
+            continue;
+        slot.accumulator += slot.settings.rate * timeElapsed;
+        int count = (int)slot.accumulator;
+        slot.accumulator -= (float)count;
+        spawn(slot.settings, count);
+    }
+
+    // integrate and bounce off the world's edges (the arrays are padded, so the loop covers whole groups of four)
+    int padded = (alive + 3) & ~3;
+    float dv = gravity * timeElapsed;
+#ifdef LGW_PARTICLES_SSE
+    const __m128 dt4 = _mm_set1_ps(timeElapsed);
+    const __m128 dv4 = _mm_set1_ps(dv);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 minX = _mm_set1_ps(bounds.p1.x), minY = _mm_set1_ps(bounds.p1.y), maxX = _mm_set1_ps(bounds.p2.x);
+    for (int i = 0; i < padded; i += 4)
+    {
+        __m128 px = _mm_loadu_ps(x + i), py = _mm_loadu_ps(y + i);
+        __m128 pvx = _mm_loadu_ps(vx + i), pvy = _mm_add_ps(_mm_loadu_ps(vy + i), dv4);
+        px = _mm_add_ps(px, _mm_mul_ps(pvx, dt4));
+        py = _mm_add_ps(py, _mm_mul_ps(pvy, dt4));
+
+        // lanes that collide and left the world are put back on the edge with their velocity reflected and scaled
+        __m128 b = _mm_loadu_ps(bounce + i);
+        __m128 collides = _mm_cmpge_ps(b, zero);
+        __m128 below = _mm_and_ps(collides, _mm_cmplt_ps(py, minY));
+        py = _mm_or_ps(_mm_and_ps(below, minY), _mm_andnot_ps(below, py));
+        pvy = _mm_or_ps(_mm_and_ps(below, _mm_mul_ps(_mm_sub_ps(zero, pvy), b)), _mm_andnot_ps(below, pvy));
+        __m128 outside = _mm_and_ps(collides, _mm_or_ps(_mm_cmplt_ps(px, minX), _mm_cmpgt_ps(px, maxX)));
+        __m128 clamped = _mm_min_ps(_mm_max_ps(px, minX), maxX);
+        px = _mm_or_ps(_mm_and_ps(collides, clamped), _mm_andnot_ps(collides, px));
+        pvx = _mm_or_ps(_mm_and_ps(outside, _mm_mul_ps(_mm_sub_ps(zero, pvx), b)), _mm_andnot_ps(outside, pvx));
+
+        _mm_storeu_ps(x + i, px);
+        _mm_storeu_ps(y + i, py);
+        _mm_storeu_ps(vx + i, pvx);
+        _mm_storeu_ps(vy + i, pvy);
+        _mm_storeu_ps(age + i, _mm_add_ps(_mm_loadu_ps(age + i), dt4));
+    }
+#else
+    for (int i = 0; i < padded; i++)
+    {
+        vy[i] += dv;
+        x[i] += vx[i] * timeElapsed;
+        y[i] += vy[i] * timeElapsed;
+        age[i] += timeElapsed;
+        if (bounce[i] < 0.0f)
+            continue;
+        if (y[i] < bounds.p1.y)
+        {
+            y[i] = bounds.p1.y;
+            vy[i] = -vy[i] * bounce[i];
+        }
+        if (x[i] < bounds.p1.x || x[i] > bounds.p2.x)
+        {
+            x[i] = std::min(std::max(x[i], bounds.p1.x), bounds.p2.x);
+            vx[i] = -vx[i] * bounce[i];
+        }
+    }
+#endif
+
+    // compact: a dead particle is replaced by the last living one (the order of particles doesn't matter)
+    int i = 0;
+    while (i < alive)
+    {
+        if (age[i] < life[i])
+        {
+            i++;
+            continue;
+        }
+        int last = --alive;
+        x[i] = x[last];
+        y[i] = y[last];
+        vx[i] = vx[last];
+        vy[i] = vy[last];
+        age[i] = age[last];
+        life[i] = life[last];
+        bounce[i] = bounce[last];
+        startColor[i] = startColor[last];
+        endColor[i] = endColor[last];
+    }
+    // reset the padding lanes behind the last living particle, so the data they keep integrating stays finite
+    for (int j = alive; j < padded; j++)
+    {
+        vx[j] = vy[j] = age[j] = 0.0f;
+        bounce[j] = -1.0f;
+    }
+}
+// ParticleSystem: draw every particle as a point
+void lgw::ParticleSystem::render(StreamBuffer& buffer, Shader* shader, float windowAspectRatio, float inverseScaleFactor, float xShift, float yShift, float pointSize)
+{
+    if (alive == 0)
+        return;
+    GLintptr offset;
+    unsigned char* vertices = (unsigned char*)buffer.map((long long)alive * lgwcon::PARTICLE_VERTEX_SIZE, lgwcon::PARTICLE_VERTEX_SIZE, offset);
+    if (vertices == nullptr)
+        return;
+    for (int i = 0; i < alive; i++)
+    {
+        // blend the colors in 8-bit fixed point
+        uint32_t t = (uint32_t)(std::min(age[i] / life[i], 1.0f) * 256.0f);
+        uint32_t s = startColor[i], e = endColor[i], color = 0;
+        for (int shift = 0; shift < 32; shift += 8)
+        {
+            uint32_t a = (s >> shift) & 0xFF, b = (e >> shift) & 0xFF;
+            color |= ((a * (256 - t) + b * t) >> 8) << shift;
+        }
+        unsigned char* vertex = vertices + (size_t)i * lgwcon::PARTICLE_VERTEX_SIZE;
+        std::memcpy(vertex, x + i, sizeof(float));
+        std::memcpy(vertex + 4, y + i, sizeof(float));
+        std::memcpy(vertex + 8, &color, sizeof(uint32_t));
+    }
+    buffer.unmap();
+
+    shader->use();
+    glUniform4f(shader->uniLoc("view"), 2.0f / (windowAspectRatio * inverseScaleFactor), 2.0f / inverseScaleFactor, xShift, yShift);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glPointSize(pointSize);
+    glBindVertexArray(VAO);
+    glDrawArrays(GL_POINTS, (GLint)(offset / lgwcon::PARTICLE_VERTEX_SIZE), alive);
+    glBindVertexArray(0);
+    glDisable(GL_BLEND);
+}
\ No newline at end of file
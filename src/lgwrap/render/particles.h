@@ -0,0 +1,108 @@
+#pragma once
+
+#include <iostream> // for debug
+#include <vector>
+#include <cstdint>
+
+// public (external) libraries
+#include <glad/glad.h> // loader for OpenGL
+
+// private libraries
+#include "../physics/object.h"
+#include "shader.h"
+#include "stream.h"
+
+// constants
+namespace lgwcon {
+    // largest number of particles alive at the same time
+    const int PARTICLE_CAPACITY = 131072;
+    // bytes per streamed particle vertex (vec2 world position, RGBA8 color)
+    const int PARTICLE_VERTEX_SIZE = 12;
+}
+
+namespace lgw {
+    // settings of a particle emitter (velocities and lifetimes get a random offset of up to +- the jitter)
+    struct ParticleEmitter {
+        Point position;
+        // particles per second (0 for emitters that are only used for bursts)
+        float rate = 0.0f;
+        // lifetime in seconds
+        float lifetime = 1.0f;
+        float lifetimeJitter = 0.0f;
+        Vector velocity;
+        Vector velocityJitter;
+        // color at the start and at the end of a particle's life (RGBA, blended linearly in between)
+        float startColor[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+        float endColor[4] = { 1.0f, 1.0f, 1.0f, 0.0f };
+        // bounce off the edges of the static world (bounce is the fraction of the velocity kept)
+        bool collide = false;
+        float bounce = 0.5f;
+        // emitters that aren't active don't spawn particles
+        bool active = true;
+    };
+
+    // particle subsystem: particles are stored as separate arrays per field (structure of arrays) and updated four at
+    // a time with SSE; dead particles are replaced by the last living one, so the arrays never reallocate; all
+    // particles are drawn as points with one streamed draw through the world-space vertex color shader
+    class ParticleSystem {
+    public:
+        // constructor
+        ParticleSystem(int capacity = lgwcon::PARTICLE_CAPACITY);
+        // destructor
+        ~ParticleSystem(void);
+        // the arrays are owned by the system
+        ParticleSystem(const ParticleSystem&) = delete;
+        ParticleSystem& operator=(const ParticleSystem&) = delete;
+        // create the vertex array that reads particle vertices from the stream buffer (needs a current GL context)
+        void init(const StreamBuffer& buffer);
+        // add an emitter and return its ID
+        int addEmitter(const ParticleEmitter& emitter);
+        // settings of an emitter (can be changed at any time)
+        inline ParticleEmitter& emitter(int id) { return emitters[id].settings; }
+        // remove an emitter (its particles live on)
+        void removeEmitter(int id);
+        // spawn 'count' particles at once
+        void burst(const ParticleEmitter& emitter, int count);
+        // gravity and the edges of the static world that colliding particles bounce off
+        inline void setGravity(float acceleration) { gravity = acceleration; }
+        inline void setBounds(const Box& area) { bounds = area; }
+        // spawn from the emitters, move every particle and remove the dead ones
+        void update(float timeElapsed);
+        // draw every particle as a point of 'pointSize' pixels (the shader is the one used for static chunks)
+        void render(StreamBuffer& buffer, Shader* shader, float windowAspectRatio, float inverseScaleFactor, float xShift, float yShift, float pointSize);
+        // number of living particles
+        inline int count(void) const { return alive; }
+    private:
+        // particle fields (allocated for the capacity rounded up to a multiple of 4, so the SIMD loop needs no tail)
+        float* x = nullptr;
+        float* y = nullptr;
+        float* vx = nullptr;
+        float* vy = nullptr;
+        float* age = nullptr;
+        float* life = nullptr;
+        // fraction of the velocity kept when bouncing (negative for particles that don't collide)
+        float* bounce = nullptr;
+        // colors at the start and the end of the particle's life (RGBA8, red in the lowest byte)
+        uint32_t* startColor = nullptr;
+        uint32_t* endColor = nullptr;
+        int alive = 0;
+        int maxParticles;
+        // emitters and the particles they still owe from fractional spawn counts
+        struct EmitterSlot {
+            ParticleEmitter settings;
+            float accumulator = 0.0f;
+            bool used = false;
+        };
+        std::vector<EmitterSlot> emitters;
+        std::vector<int> freeEmitters;
+        float gravity = -9.8f;
+        Box bounds;
+        // random number generator for the jitter (xorshift)
+        uint32_t seed = 0x9E3779B9u;
+        GLuint VAO = 0;
+        // random number between -1 and 1
+        float random(void);
+        // spawn 'count' particles from an emitter (as many as fit)
+        void spawn(const ParticleEmitter& emitter, int count);
+    };
+}
\ No newline at end of file
@@ -0,0 +1,225 @@
+#include "profiler.h"
+
+#include <fstream> // for the trace export
+#include <iomanip> // for std::setprecision
+#include <algorithm> // for std::sort
+#include <cstring> // for std::strcmp
+
+// profiler: constructor
+lgw::Profiler::Profiler(void) : frames(lgwcon::PROFILER_HISTORY) {}
+// profiler: destructor
+lgw::Profiler::~Profiler(void)
+{
+    for (QuerySlot& slot : slots)
+    {
+        if (!slot.queries.empty())
+            glDeleteQueries((GLsizei)slot.queries.size(), slot.queries.data());
+    }
+}
+// profiler: end the previous frame and start a new one
+void lgw::Profiler::beginFrame(void)
+{
+    double now = glfwGetTime();
+    // close anything left open
+    while (depth > 0)
+        end();
+    if (frameIndex >= 0)
+        current().end = now;
+
+    frameIndex++;
+    ProfileFrame& frame = current();
+    frame.index = frameIndex;
+    frame.start = now;
+    frame.end = now;
+    frame.events.clear();
+
+    // the slot this frame uses was last used PROFILER_QUERY_FRAMES frames ago; its results are in by now
+    // (or, in the rare case they aren't, the wait is short since the GPU is at most that many frames behind)
+    QuerySlot& slot = slots[frameIndex % lgwcon::PROFILER_QUERY_FRAMES];
+    collect(slot);
+    slot.frame = frameIndex;
+    slot.events.clear();
+}
+// profiler: open a zone inside the current one
+void lgw::Profiler::begin(const char* name, bool gpu)
+{
+    if (frameIndex < 0)
+        beginFrame();
+    ProfileFrame& frame = current();
+    int event = (int)frame.events.size();
+    frame.events.push_back({ name, depth, glfwGetTime(), 0.0, -1.0 });
+    if (depth < lgwcon::PROFILER_MAX_DEPTH)
+        stack[depth] = event;
+    depth++;
+
+    // only one GL_TIME_ELAPSED query can be active, so inner GPU zones are timed by their outermost parent
+    if (gpu && gpuEvent < 0 && depth <= lgwcon::PROFILER_MAX_DEPTH)
+    {
+        QuerySlot& slot = slots[frameIndex % lgwcon::PROFILER_QUERY_FRAMES];
+        if (slot.events.size() == slot.queries.size())
+        {
+            GLuint query;
+            glGenQueries(1, &query);
+            slot.queries.push_back(query);
+        }
+        glBeginQuery(GL_TIME_ELAPSED, slot.queries[slot.events.size()]);
+        slot.events.push_back(event);
+        gpuEvent = event;
+    }
+}
+// profiler: close the innermost open zone
+void lgw::Profiler::end(void)
+{
+    if (depth == 0)
+        return;
+    depth--;
+    if (depth >= lgwcon::PROFILER_MAX_DEPTH)
+        return;
+    int event = stack[depth];
+    current().events[event].end = glfwGetTime();
+    if (event == gpuEvent)
+    {
+        glEndQuery(GL_TIME_ELAPSED);
+        gpuEvent = -1;
+    }
+}
+// profiler: read back the results of the slot that's about to be reused
+void lgw::Profiler::collect(QuerySlot& slot)
+{
+    if (slot.frame < 0)
+        return;
+    // the frame may already have been overwritten in the history if the ring is shorter than the query latency
+    ProfileFrame& frame = frames[slot.frame % lgwcon::PROFILER_HISTORY];
+    bool stored = frame.index == slot.frame;
+    for (size_t i = 0; i < slot.events.size(); i++)
+    {
+        GLuint64 nanoseconds = 0;
+        glGetQueryObjectui64v(slot.queries[i], GL_QUERY_RESULT, &nanoseconds);
+        if (stored)
+            frame.events[slot.events[i]].gpu = nanoseconds / 1000000000.0;
+    }
+}
+// profiler: duration of the last completed frame
+double lgw::Profiler::lastFrame(void) const
+{
+    if (frameIndex < 1)
+        return 0.0;
+    const ProfileFrame& frame = frames[(frameIndex - 1) % lgwcon::PROFILER_HISTORY];
+    return frame.end - frame.start;
+}
+// profiler: p-th percentile of the frame times in the history
+double lgw::Profiler::percentile(double p, Arena* scratch) const
+{
+    ArenaVector<double> times{ ArenaAllocator<double>(scratch) };
+    times.reserve(frames.size());
+    for (const ProfileFrame& frame : frames)
+    {
+        // skip unused entries and the frame in progress
+        if (frame.index >= 0 && frame.index != frameIndex)
+            times.push_back(frame.end - frame.start);
+    }
+    if (times.empty())
+        return 0.0;
+    std::sort(times.begin(), times.end());
+    size_t rank = (size_t)(p / 100.0 * (times.size() - 1) + 0.5);
+    return times[std::min(rank, times.size() - 1)];
+}
+// profiler: average CPU and GPU time of every zone with the given name over the history
+void lgw::Profiler::average(const char* name, double& cpu, double& gpu) const
+{
+    double cpuSum = 0.0, gpuSum = 0.0;
+    int cpuFrames = 0, gpuFrames = 0;
+    for (const ProfileFrame& frame : frames)
+    {
+        if (frame.index < 0 || frame.index == frameIndex)
+            continue;
+        double frameCpu = 0.0, frameGpu = 0.0;
+        bool found = false, measured = false;
+        for (const ProfileEvent& event : frame.events)
+        {
+            if (std::strcmp(event.name, name) != 0)
+                continue;
+            found = true;
+            frameCpu += event.end - event.start;
+            if (event.gpu >= 0.0)
+            {
+                measured = true;
+                frameGpu += event.gpu;
+            }
+        }
+        if (found)
+        {
+            cpuSum += frameCpu;
+            cpuFrames++;
+        }
+        if (measured)
+        {
+            gpuSum += frameGpu;
+            gpuFrames++;
+        }
+    }
+    cpu = cpuFrames > 0 ? cpuSum / cpuFrames : 0.0;
+    gpu = gpuFrames > 0 ? gpuSum / gpuFrames : -1.0;
+}
+// profiler: fill 'vertices' with a line strip of the frame time history inside the given area
+int lgw::Profiler::graph(float* vertices, int maxPoints, float x, float y, float width, float height, double fullScale) const
+{
+    int points = 0;
+    int count = std::min(maxPoints, lgwcon::PROFILER_HISTORY - 1);
+    if (count < 2)
+        return 0;
+    // oldest completed frame first
+    for (long long i = frameIndex - count; i < frameIndex; i++)
+    {
+        if (i < 0)
+            continue;
+        const ProfileFrame& frame = frames[i % lgwcon::PROFILER_HISTORY];
+        double fraction = std::min((frame.end - frame.start) / fullScale, 1.0);
+        vertices[points * 2] = x + width * (float)(count - (frameIndex - i)) / (float)(count - 1);
+        vertices[points * 2 + 1] = y + height * (float)fraction;
+        points++;
+    }
+    return points;
+}
+// profiler: write the history as a Chrome trace JSON file
+int lgw::Profiler::exportTrace(const std::string& path) const
+{
+    std::ofstream file(path);
+    if (!file.is_open())
+    {
+        std::cout << "profiler: failed to open " << path << std::endl;
+        return 1;
+    }
+
+    // oldest completed frame first; timestamps are microseconds from the start of that frame
+    long long first = std::max(0LL, frameIndex - lgwcon::PROFILER_HISTORY + 1);
+    if (first >= frameIndex)
+    {
+        file << "{\"traceEvents\":[]}";
+        return 0;
+    }
+    double origin = frames[first % lgwcon::PROFILER_HISTORY].start;
+    file << std::fixed << std::setprecision(3);
+    file << "{\"traceEvents\":[\n";
+    file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"CPU\"}},\n";
+    file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"GPU (GL_TIME_ELAPSED, placed at the CPU start)\"}}";
+    for (long long i = first; i < frameIndex; i++)
+    {
+        const ProfileFrame& frame = frames[i % lgwcon::PROFILER_HISTORY];
+        file << ",\n{\"name\":\"frame " << frame.index << "\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":"
+            << (frame.start - origin) * 1000000.0 << ",\"dur\":" << (frame.end - frame.start) * 1000000.0 << "}";
+        for (const ProfileEvent& event : frame.events)
+        {
+            file << ",\n{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":"
+                << (event.start - origin) * 1000000.0 << ",\"dur\":" << (event.end - event.start) * 1000000.0 << "}";
+            if (event.gpu >= 0.0)
+            {
+                file << ",\n{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":2,\"ts\":"
+                    << (event.start - origin) * 1000000.0 << ",\"dur\":" << event.gpu * 1000000.0 << "}";
+            }
+        }
+    }
+    file << "\n]}";
+    file.close();
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <iostream> // for debug
+#include <string>
+#include <vector>
+
+// public (external) libraries
+#include <glad/glad.h> // loader for OpenGL
+#include <GLFW/glfw3.h> // for glfwGetTime
+
+// private libraries
+#include "../utils/arena.h"
+
+// constants
+namespace lgwcon {
+    // number of frames kept for the graph, the percentiles and the trace export
+    const int PROFILER_HISTORY = 300;
+    // number of frames GPU queries are given to finish before their results are read
+    const int PROFILER_QUERY_FRAMES = 4;
+    // deepest zone nesting that is recorded
+    const int PROFILER_MAX_DEPTH = 16;
+}
+
+namespace lgw {
+    // one timed zone of a frame (times in seconds)
+    struct ProfileEvent {
+        const char* name;
+        int depth;
+        double start, end;
+        // GPU time of the zone, or -1 if it wasn't measured (or the result isn't available yet)
+        double gpu;
+    };
+    // every zone recorded during one frame
+    struct ProfileFrame {
+        long long index = -1;
+        double start = 0.0, end = 0.0;
+        std::vector<ProfileEvent> events;
+    };
+
+    // hierarchical frame profiler: CPU time of nested zones, GPU time of the outermost GPU zones (GL_TIME_ELAPSED
+    // queries can't nest) read back a few frames later from a ring of query pools, a rolling history of whole frames
+    // and export to the Chrome trace format (chrome://tracing or ui.perfetto.dev)
+    class Profiler {
+    public:
+        // constructor
+        Profiler(void);
+        // destructor
+        ~Profiler(void);
+        // end the previous frame and start a new one (call once at the top of the frame)
+        void beginFrame(void);
+        // open a zone inside the current one (gpu: also measure the GPU time of the zone, needs a current GL context)
+        void begin(const char* name, bool gpu = false);
+        // close the innermost open zone
+        void end(void);
+        // duration of the last completed frame
+        double lastFrame(void) const;
+        // p-th percentile (0-100) of the frame times in the history (the sorted copy of the history is taken from
+        // 'scratch' if one is given)
+        double percentile(double p, Arena* scratch = nullptr) const;
+        // average CPU and GPU time of every zone with the given name over the history (gpu is -1 if never measured)
+        void average(const char* name, double& cpu, double& gpu) const;
+        // fill 'vertices' with a line strip (x, y pairs) of the frame time history inside the given area
+        // ('fullScale' is the frame time at the top of the area; returns the number of points written)
+        int graph(float* vertices, int maxPoints, float x, float y, float width, float height, double fullScale) const;
+        // write the history as a Chrome trace JSON file (returns 0 on success)
+        int exportTrace(const std::string& path) const;
+    private:
+        // ring of recorded frames (current = index % PROFILER_HISTORY)
+        std::vector<ProfileFrame> frames;
+        long long frameIndex = -1;
+        // indices into the current frame's events of the zones that are still open
+        int stack[lgwcon::PROFILER_MAX_DEPTH];
+        int depth = 0;
+        // queries issued during one frame, waiting for their results
+        struct QuerySlot {
+            long long frame = -1;
+            std::vector<GLuint> queries;
+            // event index that every used query belongs to
+            std::vector<int> events;
+        };
+        QuerySlot slots[lgwcon::PROFILER_QUERY_FRAMES];
+        // zone that currently owns the GL_TIME_ELAPSED query (-1 if none)
+        int gpuEvent = -1;
+        // read back the results of the slot that's about to be reused
+        void collect(QuerySlot& slot);
+        inline ProfileFrame& current(void) { return frames[frameIndex % lgwcon::PROFILER_HISTORY]; }
+    };
+
+    // scoped zone: opens a zone on construction and closes it on destruction
+    class ProfileZone {
+    public:
+        inline ProfileZone(Profiler& profiler, const char* name, bool gpu = false) : owner(profiler) { owner.begin(name, gpu); }
+        inline ~ProfileZone(void) { owner.end(); }
+    private:
+        Profiler& owner;
+    };
+}
\ No newline at end of file
@@ -1,7 +1,24 @@
 #include "shader.h"
 
+#include <iomanip> // for formatting cache file names
+#include <cstring> // for std::memcmp and std::memcpy
+
+// private libraries
+#include "../utils/mapped.h" // for hashBytes and createDirectory
+
+namespace {
+    // header of a shader cache file (followed by the program binary)
+    struct CacheHeader {
+        char magic[4];
+        unsigned int version;
+        unsigned long long key;
+        unsigned int format;
+        unsigned int length;
+    };
+}
+
 // shader error handler
-int lgw::shaderHandleError(int error, char infoLog[lgwcon::SHADER_LOG_SIZE] = '\0')
+int lgw::shaderHandleError(int error, char infoLog[lgwcon::SHADER_LOG_SIZE])
 {
     switch (error)
     {
@@ -23,7 +40,7 @@ int lgw::shaderHandleError(int error, char infoLog[lgwcon::SHADER_LOG_SIZE] = '\
     }
     }
 
-    std::cout << std::endl << infoLog << std::endl;
+    std::cout << std::endl << (infoLog != nullptr ? infoLog : "") << std::endl;
 
     return error;
 }
@@ -34,6 +51,11 @@ lgw::VertexShader::VertexShader(GLenum type, const char* sourceDir) : dir(source
 lgw::VertexShader::~VertexShader(void) { glDeleteShader(id_); }
 // vertex shader: load the contents of a file
 std::string lgw::VertexShader::getFileContents(std::string dir)
+{
+    return readShaderSource(dir);
+}
+// read a shader source file
+std::string lgw::readShaderSource(const std::string& dir)
 {
     // open file
     std::ifstream file(dir);
@@ -50,10 +72,14 @@ std::string lgw::VertexShader::getFileContents(std::string dir)
 int lgw::VertexShader::compile(void)
 {
     // get source from file directory
-    std::string buffer = getFileContents(dir);
+    return compile(getFileContents(dir));
+}
+// vertex shader: compile from source that was already read
+int lgw::VertexShader::compile(const std::string& buffer)
+{
+    if (buffer.empty())
+        return shaderHandleError(lgwcon::SHADER_LOAD_FAILED, nullptr);
     const char* source = buffer.c_str();
-    if (source == std::string())
-        return shaderHandleError(lgwcon::SHADER_LOAD_FAILED);
     // compile shader
     id_ = glCreateShader(shaderType);
     glShaderSource(id_, 1, &source, NULL);
@@ -73,12 +99,16 @@ int lgw::VertexShader::compile(void)
 
 // shader program: constructor
 lgw::Shader::Shader(VertexShader& vertexShader, FragmentShader& fragmentShader) : vertex(vertexShader.id), fragment(fragmentShader.id) {}
+// shader program: constructor for a program that is created from a program binary
+lgw::Shader::Shader(void) : vertex(0), fragment(0) {}
 // shader program: destructor
 lgw::Shader::~Shader(void) { glDeleteProgram(id_); }
 // shader program: link vertex shader and fragment shader
-int lgw::Shader::link(void)
+int lgw::Shader::link(bool retrievable)
 {
     id_ = glCreateProgram();
+    if (retrievable)
+        glProgramParameteri(id_, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
     glAttachShader(id_, vertex);
     glAttachShader(id_, fragment);
     glLinkProgram(id_);
@@ -87,18 +117,200 @@ int lgw::Shader::link(void)
     if (!success) {
         char infoLog[lgwcon::SHADER_LOG_SIZE];
         glGetProgramInfoLog(id_, lgwcon::SHADER_LOG_SIZE, NULL, infoLog);
+        glDeleteProgram(id_);
         id_ = 0;
         return shaderHandleError(lgwcon::SHADER_LINK_FAILED, infoLog);
     }
     return 0;
 }
+// shader program: create the program from a program binary
+int lgw::Shader::loadBinary(GLenum format, const void* binary, GLsizei length)
+{
+    id_ = glCreateProgram();
+    glProgramBinary(id_, format, binary, length);
+    int success;
+    glGetProgramiv(id_, GL_LINK_STATUS, &success);
+    if (!success)
+    {
+        // not worth a log message: the driver rejects binaries from other driver versions and the caller recompiles
+        glDeleteProgram(id_);
+        id_ = 0;
+        return lgwcon::SHADER_LINK_FAILED;
+    }
+    return 0;
+}
 // shader program: use shader program
 void lgw::Shader::use(void)
 {
     glUseProgram(id_);
 }
 // shader program: get attribute location
-GLint lgw::Shader::uniLoc(std::string attribute)
+GLint lgw::Shader::uniLoc(const char* attribute)
+{
+    return glGetUniformLocation(id_, attribute);
+}
+
+// shader cache: constructor
+lgw::ShaderCache::ShaderCache(const std::string& directory) : directory(directory) {}
+// shader cache: check for driver support and create the cache directory
+int lgw::ShaderCache::init(GLADloadproc load)
+{
+    // program binaries are core in 4.1 and otherwise come from ARB_get_program_binary (same function names)
+    if (!GLAD_GL_VERSION_4_1)
+    {
+        bool supported = false;
+        GLint extensionCount = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+        for (GLint i = 0; i < extensionCount && !supported; i++)
+            supported = std::strcmp((const char*)glGetStringi(GL_EXTENSIONS, i), "GL_ARB_get_program_binary") == 0;
+        if (supported)
+        {
+            glad_glGetProgramBinary = (PFNGLGETPROGRAMBINARYPROC)load("glGetProgramBinary");
+            glad_glProgramBinary = (PFNGLPROGRAMBINARYPROC)load("glProgramBinary");
+            glad_glProgramParameteri = (PFNGLPROGRAMPARAMETERIPROC)load("glProgramParameteri");
+        }
+    }
+    GLint formatCount = 0;
+    if (glGetProgramBinary != nullptr && glProgramBinary != nullptr && glProgramParameteri != nullptr)
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+    if (formatCount <= 0)
+    {
+        std::cout << "gl: the driver can't save program binaries; shaders are compiled at every start" << std::endl;
+        return -1;
+    }
+
+    // the driver strings are part of the key, so a driver update misses the cache instead of feeding the new driver
+    // a binary it may not check properly
+    const char* strings[3] = { (const char*)glGetString(GL_VENDOR), (const char*)glGetString(GL_RENDERER), (const char*)glGetString(GL_VERSION) };
+    driverHash = hashBytes(&lgwcon::SHADER_CACHE_VERSION, sizeof(lgwcon::SHADER_CACHE_VERSION));
+    for (const char* string : strings)
+    {
+        if (string != nullptr)
+            driverHash = hashBytes(string, std::strlen(string) + 1, driverHash);
+    }
+
+    if (createDirectory(directory))
+    {
+        std::cout << "gl: failed to create the shader cache directory " << directory << std::endl;
+        return -1;
+    }
+    enabled_ = true;
+    return 0;
+}
+// shader cache: cache key of a pair of sources
+unsigned long long lgw::ShaderCache::key(const std::string& vertexSource, const std::string& fragmentSource) const
+{
+    // the terminating zero keeps "ab" + "c" and "a" + "bc" apart
+    unsigned long long hash = hashBytes(vertexSource.c_str(), vertexSource.size() + 1, driverHash);
+    return hashBytes(fragmentSource.c_str(), fragmentSource.size() + 1, hash);
+}
+// shader cache: file a key is stored in
+std::string lgw::ShaderCache::path(unsigned long long key) const
+{
+    std::stringstream name;
+    name << directory << std::hex << std::setw(16) << std::setfill('0') << key << ".bin";
+    return name.str();
+}
+// shader cache: create a program from a cached binary
+lgw::Shader* lgw::ShaderCache::load(const std::string& vertexSource, const std::string& fragmentSource)
+{
+    if (!enabled_)
+    {
+        missCount++;
+        return nullptr;
+    }
+    unsigned long long programKey = key(vertexSource, fragmentSource);
+    std::ifstream file(path(programKey), std::ios::binary);
+    CacheHeader header;
+    if (!file.is_open() || !file.read(reinterpret_cast<char*>(&header), sizeof(header))
+        || std::memcmp(header.magic, lgwcon::SHADER_CACHE_MAGIC, 4) != 0 || header.version != lgwcon::SHADER_CACHE_VERSION
+        || header.key != programKey)
+    {
+        missCount++;
+        return nullptr;
+    }
+    // the length comes from the file, so it's checked against what's left of it before anything is allocated
+    std::streamoff start = file.tellg();
+    file.seekg(0, std::ios::end);
+    std::streamoff remaining = file.tellg() - start;
+    file.seekg(start);
+    if (header.length == 0 || remaining < 0 || (unsigned long long)header.length > (unsigned long long)remaining)
+    {
+        missCount++;
+        return nullptr;
+    }
+    std::vector<char> binary(header.length);
+    if (!file.read(binary.data(), header.length))
+    {
+        missCount++;
+        return nullptr;
+    }
+    Shader* shader = new Shader();
+    if (shader->loadBinary((GLenum)header.format, binary.data(), (GLsizei)header.length))
+    {
+        std::cout << "gl: cached program " << path(programKey) << " was rejected by the driver; recompiling" << std::endl;
+        delete shader;
+        missCount++;
+        return nullptr;
+    }
+    hitCount++;
+    return shader;
+}
+// shader cache: write the binary of a program
+void lgw::ShaderCache::store(const std::string& vertexSource, const std::string& fragmentSource, const Shader& shader)
 {
-    return glGetUniformLocation(id_, attribute.c_str());
+    if (!enabled_)
+        return;
+    GLint length = 0;
+    glGetProgramiv(shader.id, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    glGetProgramBinary(shader.id, length, &length, &format, binary.data());
+
+    CacheHeader header;
+    std::memcpy(header.magic, lgwcon::SHADER_CACHE_MAGIC, 4);
+    header.version = lgwcon::SHADER_CACHE_VERSION;
+    header.key = key(vertexSource, fragmentSource);
+    header.format = format;
+    header.length = (unsigned int)length;
+    std::ofstream file(path(header.key), std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(binary.data(), length);
+    if (!file)
+        std::cout << "gl: failed to write " << path(header.key) << std::endl;
+}
+
+// compile a vertex and a fragment shader and link them into a program (or load the program from the cache)
+lgw::Shader* lgw::createShader(const std::string& vertexDir, const std::string& fragmentDir, ShaderCache* cache)
+{
+    return linkShader(readShaderSource(vertexDir), readShaderSource(fragmentDir), cache);
+}
+// compile and link shaders from sources that were already read
+lgw::Shader* lgw::linkShader(const std::string& vertexSource, const std::string& fragmentSource, ShaderCache* cache)
+{
+    VertexShader vertexShader(GL_VERTEX_SHADER, "");
+    FragmentShader fragmentShader(GL_FRAGMENT_SHADER, "");
+    if (cache != nullptr)
+    {
+        Shader* shader = cache->load(vertexSource, fragmentSource);
+        if (shader != nullptr)
+            return shader;
+    }
+    if (vertexShader.compile(vertexSource))
+        return nullptr;
+    if (fragmentShader.compile(fragmentSource))
+        return nullptr;
+    Shader* shader = new Shader(vertexShader, fragmentShader);
+    bool cached = cache != nullptr && cache->enabled();
+    if (shader->link(cached))
+    {
+        delete shader;
+        return nullptr;
+    }
+    if (cached)
+        cache->store(vertexSource, fragmentSource, *shader);
+    // the shader objects are deleted when they go out of scope; the linked program keeps what it needs
+    return shader;
 }
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include <fstream>
 #include <sstream>
 #include <string>
+#include <vector>
 #include <glad/glad.h>
 
 // constants
@@ -14,6 +15,10 @@ namespace lgwcon {
     const int SHADER_LOAD_FAILED = 1;
     const int SHADER_COMP_FAILED = 2;
     const int SHADER_LINK_FAILED = 3;
+    // shader cache
+    const char SHADER_CACHE_MAGIC[4] = { 'L', 'G', 'W', 'S' };
+    // version of the cache file layout (part of the cache key, so changing it invalidates every cached program)
+    const unsigned int SHADER_CACHE_VERSION = 1;
 }
 
 namespace lgw {
@@ -40,6 +45,8 @@ namespace lgw {
         ~VertexShader(void);
         // compile from source
         int compile(void);
+        // compile from source that was already read
+        int compile(const std::string& source);
     };
     // fragment shader (identical to a vertex shader in all but name)
     typedef VertexShader FragmentShader;
@@ -58,13 +65,59 @@ namespace lgw {
         const GLuint& id = id_;
         // constructor
         Shader(VertexShader& vertexShader, FragmentShader& fragmentShader);
+        // constructor for a program that is created from a program binary
+        Shader(void);
         // destructor
         ~Shader(void);
-        // link vertex shader and fragment shader
-        int link(void);
+        // link vertex shader and fragment shader (with 'retrievable' set the driver keeps the program binary around
+        // so it can be written to the shader cache)
+        int link(bool retrievable = false);
+        // create the program from a program binary (returns SHADER_LINK_FAILED if the driver rejects the binary)
+        int loadBinary(GLenum format, const void* binary, GLsizei length);
         // use shader program
         void use(void);
-        // get attribute location (std::string)
-        GLint uniLoc(std::string attribute);
+        // get attribute location
+        GLint uniLoc(const char* attribute);
     };
+
+    // on-disk cache of linked program binaries
+    // (a program is stored under a hash of its sources and the driver's vendor, renderer and version strings, so editing
+    // a shader or updating the driver misses the cache; anything that doesn't load falls back to compiling from source)
+    class ShaderCache {
+    public:
+        // constructor
+        ShaderCache(const std::string& directory);
+        // check for driver support and create the cache directory ('load' is the function used to load the OpenGL
+        // function pointers, needed because program binaries are only core from OpenGL 4.1; returns -1 if the driver
+        // can't save program binaries, in which case the cache stays disabled)
+        int init(GLADloadproc load);
+        // true if init succeeded
+        inline bool enabled(void) const { return enabled_; }
+        // create a program from a cached binary (returns nullptr on a miss or if the cached binary is invalid)
+        Shader* load(const std::string& vertexSource, const std::string& fragmentSource);
+        // write the binary of a program linked with 'retrievable' set
+        void store(const std::string& vertexSource, const std::string& fragmentSource, const Shader& shader);
+        // number of programs loaded from the cache and compiled from source
+        inline int hits(void) const { return hitCount; }
+        inline int misses(void) const { return missCount; }
+    private:
+        std::string directory;
+        bool enabled_ = false;
+        // hash of the driver strings (combined with the hash of the sources)
+        unsigned long long driverHash = 0;
+        int hitCount = 0;
+        int missCount = 0;
+        // cache key of a pair of sources and the file it's stored in
+        unsigned long long key(const std::string& vertexSource, const std::string& fragmentSource) const;
+        std::string path(unsigned long long key) const;
+    };
+
+    // read a shader source file (returns an empty string if it can't be opened; doesn't touch GL, so it can run on any
+    // thread)
+    std::string readShaderSource(const std::string& dir);
+    // compile a vertex and a fragment shader from their source files and link them into a program (returns nullptr on
+    // failure; with a cache the linked program is loaded from or written to it)
+    Shader* createShader(const std::string& vertexDir, const std::string& fragmentDir, ShaderCache* cache = nullptr);
+    // same as createShader, for sources that were already read
+    Shader* linkShader(const std::string& vertexSource, const std::string& fragmentSource, ShaderCache* cache = nullptr);
 }
\ No newline at end of file
@@ -0,0 +1,92 @@
+#include "stream.h"
+
+// stream buffer: constructor
+lgw::StreamBuffer::StreamBuffer(long long size) : capacity(size) {}
+// stream buffer: destructor
+lgw::StreamBuffer::~StreamBuffer(void)
+{
+    for (Frame& frame : frames)
+        glDeleteSync(frame.fence);
+    glDeleteBuffers(1, &id_);
+}
+// stream buffer: create the buffer
+void lgw::StreamBuffer::init(void)
+{
+    glGenBuffers(1, &id_);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, id_);
+    glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)capacity, nullptr, GL_STREAM_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+// stream buffer: wait for every frame that used bytes before 'position' in the previous lap
+void lgw::StreamBuffer::reclaim(long long position)
+{
+    // the bytes about to be written were last used at (position - capacity); frames finish in order,
+    // so it's enough to walk the queue from the oldest frame
+    while (!frames.empty() && frames.front().start < position - capacity)
+    {
+        Frame& frame = frames.front();
+        GLenum status = glClientWaitSync(frame.fence, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+        {
+            // the GPU is a whole buffer behind; flush and block until it catches up
+            glClientWaitSync(frame.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+        }
+        glDeleteSync(frame.fence);
+        frames.pop_front();
+    }
+}
+// stream buffer: reserve and map a range
+void* lgw::StreamBuffer::map(long long size, long long alignment, GLintptr& offset)
+{
+    if (size > capacity)
+    {
+        std::cout << "gl: stream buffer request of " << size << " bytes is bigger than the buffer" << std::endl;
+        return nullptr;
+    }
+
+    // align the ring offset, and start over at the beginning of the buffer if the range doesn't fit at the end
+    long long ringOffset = head % capacity;
+    long long aligned = ((ringOffset + alignment - 1) / alignment) * alignment;
+    if (aligned + size > capacity)
+        aligned = capacity;
+    head += aligned - ringOffset;
+    if (head % capacity == 0)
+        aligned = 0;
+
+    if (head + size - capacity > frameStart)
+    {
+        // the current frame alone wrapped all the way around: give the driver a fresh buffer instead of overwriting
+        // data that the frame's earlier draws still need (the old storage is released once those draws are done)
+        glBindBuffer(GL_COPY_WRITE_BUFFER, id_);
+        glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)capacity, nullptr, GL_STREAM_DRAW);
+        for (Frame& frame : frames)
+            glDeleteSync(frame.fence);
+        frames.clear();
+        frameStart = head;
+        orphanCount++;
+    }
+    else
+    {
+        reclaim(head + size);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, id_);
+    }
+
+    offset = (GLintptr)aligned;
+    head += size;
+    return glMapBufferRange(GL_COPY_WRITE_BUFFER, offset, (GLsizeiptr)size,
+        GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+}
+// stream buffer: finish writing the last mapped range
+void lgw::StreamBuffer::unmap(void)
+{
+    glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+// stream buffer: fence everything written during the frame
+void lgw::StreamBuffer::endFrame(void)
+{
+    if (head == frameStart)
+        return;
+    frames.push_back({ glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), frameStart, head });
+    frameStart = head;
+}
\ No newline at end of file
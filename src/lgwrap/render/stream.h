@@ -0,0 +1,58 @@
+#pragma once
+
+#include <iostream> // for debug
+#include <deque>
+
+// public (external) libraries
+#include <glad/glad.h> // loader for OpenGL
+
+// constants
+namespace lgwcon {
+    // size of the shared streaming buffer in bytes
+    const long long STREAM_BUFFER_SIZE = 4 * 1024 * 1024;
+}
+
+namespace lgw {
+    // ring buffer for per-frame vertex and index data
+    // (writes go through unsynchronized maps, so the driver never stalls on draws that still read older parts of
+    // the buffer; fences placed at the end of every frame tell when a region can be written again)
+    class StreamBuffer {
+    private:
+        // buffer ID
+        GLuint id_ = 0;
+        // size of the buffer in bytes
+        long long capacity;
+        // total number of bytes handed out so far (the ring offset is head % capacity)
+        long long head = 0;
+        // value of head at the start of the current frame
+        long long frameStart = 0;
+        // fence and byte range of every frame the GPU may still be reading
+        struct Frame {
+            GLsync fence;
+            long long start, end;
+        };
+        std::deque<Frame> frames;
+        // number of times the buffer had to be orphaned because a single frame needed more than its capacity
+        int orphanCount = 0;
+        // wait for (and then forget) every frame that used bytes before 'position' in the previous lap
+        void reclaim(long long position);
+    public:
+        // buffer ID reference
+        const GLuint& id = id_;
+        // constructor
+        StreamBuffer(long long size = lgwcon::STREAM_BUFFER_SIZE);
+        // destructor
+        ~StreamBuffer(void);
+        // create the buffer (needs a current GL context)
+        void init(void);
+        // reserve 'size' bytes whose offset is a multiple of 'alignment' and map them for writing
+        // (returns nullptr if the request is bigger than the whole buffer; call unmap before drawing)
+        void* map(long long size, long long alignment, GLintptr& offset);
+        // finish writing the last mapped range
+        void unmap(void);
+        // fence everything written during the frame (call once per frame after the last draw that reads from the buffer)
+        void endFrame(void);
+        // number of times the buffer had to be orphaned
+        inline int orphans(void) const { return orphanCount; }
+    };
+}
\ No newline at end of file
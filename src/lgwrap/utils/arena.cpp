@@ -0,0 +1,145 @@
+#include "arena.h"
+
+#include <cstdio> // for std::snprintf
+#include <algorithm> // for std::max
+
+// Arena: constructor
+lgw::Arena::Arena(size_t capacity) : block(new char[capacity]), blockSize(capacity) {}
+// Arena: destructor
+lgw::Arena::~Arena(void)
+{
+	for (Overflow& overflow : overflowBlocks)
+		delete[] overflow.memory;
+	delete[] block;
+}
+// Arena: bump 'size' bytes out of a block
+void* lgw::Arena::bump(char* memory, size_t size, size_t& used, size_t bytes, size_t alignment)
+{
+	size_t start = (used + alignment - 1) & ~(alignment - 1);
+	if (start + bytes > size)
+		return nullptr;
+	used = start + bytes;
+	return memory + start;
+}
+// Arena: allocate 'size' bytes
+void* lgw::Arena::allocate(size_t size, size_t alignment)
+{
+	if (size == 0)
+		size = 1;
+	usedBytes += size;
+	void* memory = overflowBlocks.empty() ? bump(block, blockSize, offset, size, alignment) : nullptr;
+	if (memory != nullptr)
+		return memory;
+
+	// the main block is full: continue in the newest overflow block or start a new one
+	if (!overflowBlocks.empty())
+	{
+		Overflow& last = overflowBlocks.back();
+		memory = bump(last.memory, last.size, last.offset, size, alignment);
+		if (memory != nullptr)
+			return memory;
+	}
+	size_t overflowSize = std::max(lgwcon::ARENA_OVERFLOW_BLOCK, size + alignment);
+	overflowBlocks.push_back({ new char[overflowSize], overflowSize, 0 });
+	overflowCount++;
+	Overflow& created = overflowBlocks.back();
+	return bump(created.memory, created.size, created.offset, size, alignment);
+}
+// Arena: copy a string into the arena
+char* lgw::Arena::copy(const char* text, size_t length)
+{
+	char* copied = allocate<char>(length + 1);
+	std::memcpy(copied, text, length);
+	copied[length] = '\0';
+	return copied;
+}
+// Arena: release everything allocated since the last reset
+void lgw::Arena::reset(void)
+{
+	lastFrameBytes = usedBytes;
+	peakBytes = std::max(peakBytes, usedBytes);
+	if (!overflowBlocks.empty())
+	{
+		// the frame didn't fit: grow the main block to what it used (plus the alignment padding), so the next frame
+		// with the same load stays in one block
+		for (Overflow& overflow : overflowBlocks)
+			delete[] overflow.memory;
+		overflowBlocks.clear();
+		delete[] block;
+		blockSize = std::max(blockSize * 2, usedBytes + usedBytes / 4);
+		block = new char[blockSize];
+	}
+	offset = 0;
+	usedBytes = 0;
+}
+
+// TextBuilder: constructor
+lgw::TextBuilder::TextBuilder(Arena& arena, size_t reserve) : arena(arena), buffer(arena.allocate<char>(reserve + 1)), capacity(reserve)
+{
+	buffer[0] = '\0';
+}
+// TextBuilder: make room for 'count' more characters and the terminator
+void lgw::TextBuilder::grow(size_t count)
+{
+	if (length + count <= capacity)
+		return;
+	size_t grown = std::max(capacity * 2, length + count);
+	char* moved = arena.allocate<char>(grown + 1);
+	std::memcpy(moved, buffer, length + 1);
+	buffer = moved;
+	capacity = grown;
+}
+// TextBuilder: append text
+lgw::TextBuilder& lgw::TextBuilder::operator<<(StringView text)
+{
+	grow(text.size());
+	std::memcpy(buffer + length, text.data(), text.size());
+	length += text.size();
+	buffer[length] = '\0';
+	return *this;
+}
+lgw::TextBuilder& lgw::TextBuilder::operator<<(const char* text)
+{
+	return *this << StringView(text);
+}
+lgw::TextBuilder& lgw::TextBuilder::operator<<(char c)
+{
+	return *this << StringView(&c, 1);
+}
+// TextBuilder: append numbers
+lgw::TextBuilder& lgw::TextBuilder::operator<<(int value)
+{
+	return *this << (long long)value;
+}
+lgw::TextBuilder& lgw::TextBuilder::operator<<(unsigned int value)
+{
+	return *this << (unsigned long long)value;
+}
+lgw::TextBuilder& lgw::TextBuilder::operator<<(long value)
+{
+	return *this << (long long)value;
+}
+lgw::TextBuilder& lgw::TextBuilder::operator<<(unsigned long value)
+{
+	return *this << (unsigned long long)value;
+}
+lgw::TextBuilder& lgw::TextBuilder::operator<<(long long value)
+{
+	char digits[32];
+	int count = std::snprintf(digits, sizeof(digits), "%lld", value);
+	return *this << StringView(digits, (size_t)count);
+}
+lgw::TextBuilder& lgw::TextBuilder::operator<<(unsigned long long value)
+{
+	char digits[32];
+	int count = std::snprintf(digits, sizeof(digits), "%llu", value);
+	return *this << StringView(digits, (size_t)count);
+}
+lgw::TextBuilder& lgw::TextBuilder::operator<<(double value)
+{
+	char digits[64];
+	int count = std::snprintf(digits, sizeof(digits), "%.*f", precision, value);
+	if (count < 0 || count >= (int)sizeof(digits))
+		return *this << "?";
+	return *this << StringView(digits, (size_t)count);
+}
\ No newline at end of file
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <iostream> // for debug
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <cstring>
+
+// constants
+namespace lgwcon {
+	// initial size of the per-frame arena in bytes (it grows to the peak of a frame that didn't fit)
+	const size_t FRAME_ARENA_SIZE = 256 * 1024;
+	// alignment of arena allocations that don't ask for a specific one
+	const size_t ARENA_ALIGNMENT = alignof(std::max_align_t);
+	// smallest overflow block taken from the heap when the arena runs out during a frame
+	const size_t ARENA_OVERFLOW_BLOCK = 64 * 1024;
+}
+
+namespace lgw {
+	// linear (bump) allocator for transient data: allocating moves a pointer forward, freeing is a no-op and reset
+	// releases everything at once; a frame that needs more than the arena holds gets overflow blocks from the heap,
+	// and the next reset grows the arena to that frame's peak, so after the first few frames it never touches the heap
+	class Arena {
+	public:
+		// constructor
+		Arena(size_t capacity = lgwcon::FRAME_ARENA_SIZE);
+		// destructor
+		~Arena(void);
+		// the memory is owned by the arena
+		Arena(const Arena&) = delete;
+		Arena& operator=(const Arena&) = delete;
+		// allocate 'size' bytes (valid until the next reset)
+		void* allocate(size_t size, size_t alignment = lgwcon::ARENA_ALIGNMENT);
+		// allocate an uninitialized array
+		template <typename T>
+		inline T* allocate(size_t count) { return static_cast<T*>(allocate(sizeof(T) * count, alignof(T))); }
+		// copy a string into the arena (the copy is null-terminated)
+		char* copy(const char* text, size_t length);
+		// release everything allocated since the last reset (call once at the end of the frame)
+		void reset(void);
+		// bytes allocated since the last reset
+		inline size_t used(void) const { return usedBytes; }
+		// bytes allocated during the last frame (between the last two resets)
+		inline size_t lastUsed(void) const { return lastFrameBytes; }
+		// largest number of bytes any frame allocated
+		inline size_t peak(void) const { return peakBytes; }
+		// size of the main block
+		inline size_t capacity(void) const { return blockSize; }
+		// number of overflow blocks taken from the heap since the start (stays the same once the arena has grown)
+		inline long long overflows(void) const { return overflowCount; }
+	private:
+		// main block and the bump pointer into it
+		char* block = nullptr;
+		size_t blockSize = 0;
+		size_t offset = 0;
+		// heap blocks used after the main block filled up during the current frame
+		struct Overflow {
+			char* memory;
+			size_t size;
+			size_t offset;
+		};
+		std::vector<Overflow> overflowBlocks;
+		// statistics
+		size_t usedBytes = 0;
+		size_t lastFrameBytes = 0;
+		size_t peakBytes = 0;
+		long long overflowCount = 0;
+		// bump 'size' bytes out of a block (returns nullptr if they don't fit)
+		static void* bump(char* memory, size_t size, size_t& used, size_t bytes, size_t alignment);
+	};
+
+	// standard allocator on top of an arena (deallocate is a no-op; without an arena it falls back to the heap)
+	template <typename T>
+	class ArenaAllocator {
+	public:
+		typedef T value_type;
+		Arena* arena;
+		inline ArenaAllocator(Arena* arena = nullptr) : arena(arena) {}
+		template <typename U>
+		inline ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+		inline T* allocate(size_t count)
+		{
+			if (arena != nullptr)
+				return arena->allocate<T>(count);
+			return static_cast<T*>(::operator new(sizeof(T) * count));
+		}
+		inline void deallocate(T* pointer, size_t)
+		{
+			if (arena == nullptr)
+				::operator delete(pointer);
+		}
+		template <typename U>
+		inline bool operator==(const ArenaAllocator<U>& other) const { return arena == other.arena; }
+		template <typename U>
+		inline bool operator!=(const ArenaAllocator<U>& other) const { return arena != other.arena; }
+	};
+	// vector whose storage comes from an arena (must not outlive the next reset of the arena)
+	template <typename T>
+	using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+	// non-owning view of a piece of text (not necessarily null-terminated)
+	class StringView {
+	public:
+		inline StringView(void) : text(""), length(0) {}
+		inline StringView(const char* text) : text(text), length(std::strlen(text)) {}
+		inline StringView(const char* text, size_t length) : text(text), length(length) {}
+		inline StringView(const std::string& text) : text(text.data()), length(text.size()) {}
+		inline const char* data(void) const { return text; }
+		inline size_t size(void) const { return length; }
+		inline bool empty(void) const { return length == 0; }
+		inline char operator[](size_t i) const { return text[i]; }
+		inline const char* begin(void) const { return text; }
+		inline const char* end(void) const { return text + length; }
+	private:
+		const char* text;
+		size_t length;
+	};
+
+	// builds a line of text in an arena (replaces std::stringstream for text that only lives for one frame)
+	class TextBuilder {
+	public:
+		// constructor ('reserve' is the first guess at the length; the text is moved to a bigger allocation if it's wrong)
+		TextBuilder(Arena& arena, size_t reserve = 128);
+		// append text and numbers (floating point numbers are written with the precision set by 'fixed')
+		TextBuilder& operator<<(StringView text);
+		TextBuilder& operator<<(const char* text);
+		TextBuilder& operator<<(char c);
+		TextBuilder& operator<<(int value);
+		TextBuilder& operator<<(unsigned int value);
+		TextBuilder& operator<<(long value);
+		TextBuilder& operator<<(unsigned long value);
+		TextBuilder& operator<<(long long value);
+		TextBuilder& operator<<(unsigned long long value);
+		TextBuilder& operator<<(double value);
+		// number of digits written after the decimal point
+		inline TextBuilder& fixed(int digits) { precision = digits; return *this; }
+		// finished text (valid until the next reset of the arena)
+		inline StringView view(void) const { return StringView(buffer, length); }
+		inline const char* c_str(void) const { return buffer; }
+	private:
+		Arena& arena;
+		char* buffer;
+		size_t length = 0;
+		size_t capacity;
+		int precision = 6;
+		// make room for 'count' more characters and the terminator
+		void grow(size_t count);
+	};
+}
\ No newline at end of file
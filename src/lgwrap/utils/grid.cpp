@@ -0,0 +1,132 @@
+#include "grid.h"
+#include "../physics/collision.h"
+
+// SpatialGrid: constructor
+lgw::SpatialGrid::SpatialGrid(float cellSize) : cellSize(cellSize) {}
+// SpatialGrid: cell range covered by a box
+lgw::SpatialGrid::CellRange lgw::SpatialGrid::cellRange(const Box& box)
+{
+	return {
+		(int)std::floor(box.p1.x / cellSize),
+		(int)std::floor(box.p1.y / cellSize),
+		(int)std::floor(box.p2.x / cellSize),
+		(int)std::floor(box.p2.y / cellSize)
+	};
+}
+// SpatialGrid: add an item to every cell it overlaps
+void lgw::SpatialGrid::link(int id)
+{
+	CellRange range = cellRange(items[id].box);
+	for (int x = range.x1; x <= range.x2; x++)
+		for (int y = range.y1; y <= range.y2; y++)
+			cells[cellKey(x, y)].push_back(id);
+}
+// SpatialGrid: remove an item from every cell it overlaps
+void lgw::SpatialGrid::unlink(int id)
+{
+	CellRange range = cellRange(items[id].box);
+	for (int x = range.x1; x <= range.x2; x++)
+	{
+		for (int y = range.y1; y <= range.y2; y++)
+		{
+			std::vector<int>& cell = cells[cellKey(x, y)];
+			for (size_t i = 0; i < cell.size(); i++)
+			{
+				if (cell[i] == id)
+				{
+					// order within a cell doesn't matter, so swap with the last ID instead of shifting
+					cell[i] = cell.back();
+					cell.pop_back();
+					break;
+				}
+			}
+		}
+	}
+}
+// SpatialGrid: add a box and return its ID
+int lgw::SpatialGrid::insert(const Box& box)
+{
+	int id;
+	if (!freeIDs.empty())
+	{
+		id = freeIDs.back();
+		freeIDs.pop_back();
+		items[id] = { box, stamp, true };
+	}
+	else
+	{
+		id = (int)items.size();
+		items.push_back({ box, stamp, true });
+	}
+	link(id);
+	return id;
+}
+// SpatialGrid: move an existing box
+void lgw::SpatialGrid::update(int id, const Box& box)
+{
+	CellRange oldRange = cellRange(items[id].box);
+	CellRange newRange = cellRange(box);
+	// only touch the cells when the box actually crossed a cell border
+	if (oldRange.x1 == newRange.x1 && oldRange.y1 == newRange.y1 && oldRange.x2 == newRange.x2 && oldRange.y2 == newRange.y2)
+	{
+		items[id].box = box;
+		return;
+	}
+	unlink(id);
+	items[id].box = box;
+	link(id);
+}
+// SpatialGrid: remove a box
+void lgw::SpatialGrid::remove(int id)
+{
+	if (!items[id].alive)
+		return;
+	unlink(id);
+	items[id].alive = false;
+	freeIDs.push_back(id);
+}
+// SpatialGrid: collect the IDs of all boxes that overlap 'area'
+int lgw::SpatialGrid::query(const Box& area, std::vector<int>& result)
+{
+	int found = 0;
+	stamp++;
+	CellRange range = cellRange(area);
+	long long cellCount = ((long long)range.x2 - range.x1 + 1) * ((long long)range.y2 - range.y1 + 1);
+
+	// when zoomed far out the area covers more cells than there are boxes, so testing every box is cheaper
+	if (cellCount > (long long)items.size())
+	{
+		for (int id = 0; id < (int)items.size(); id++)
+		{
+			if (items[id].alive && boxIntersectsBox(items[id].box, area))
+			{
+				result.push_back(id);
+				found++;
+			}
+		}
+		return found;
+	}
+
+	for (int x = range.x1; x <= range.x2; x++)
+	{
+		for (int y = range.y1; y <= range.y2; y++)
+		{
+			std::unordered_map<long long, std::vector<int>>::iterator cell = cells.find(cellKey(x, y));
+			if (cell == cells.end())
+				continue;
+			for (int id : cell->second)
+			{
+				// boxes that span several cells are only reported once
+				if (items[id].stamp == stamp)
+					continue;
+				items[id].stamp = stamp;
+				if (boxIntersectsBox(items[id].box, area))
+				{
+					result.push_back(id);
+					found++;
+				}
+			}
+		}
+	}
+	return found;
+}
\ No newline at end of file
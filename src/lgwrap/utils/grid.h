@@ -0,0 +1,47 @@
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include "../physics/object.h"
+
+namespace lgw {
+	// uniform grid that buckets boxes by the cells they overlap
+	// (queries only touch the cells under the queried area, so their cost doesn't grow with the size of the world)
+	class SpatialGrid {
+	public:
+		// constructor
+		SpatialGrid(float cellSize = 4.0f);
+		// add a box and return its ID
+		int insert(const Box& box);
+		// move an existing box
+		void update(int id, const Box& box);
+		// remove a box (its ID may be handed out again by insert)
+		void remove(int id);
+		// collect the IDs of all boxes that overlap 'area' (each ID is reported once); returns the number of IDs found
+		int query(const Box& area, std::vector<int>& result);
+		// return the box stored under an ID
+		inline const Box& get(int id) const { return items[id].box; }
+		// number of boxes stored in the grid
+		inline int size(void) const { return (int)items.size() - (int)freeIDs.size(); }
+	private:
+		struct Item {
+			Box box;
+			unsigned int stamp; // last query that reported this item
+			bool alive;
+		};
+		// cell range covered by a box
+		struct CellRange {
+			int x1, y1, x2, y2;
+		};
+		float cellSize;
+		std::unordered_map<long long, std::vector<int>> cells;
+		std::vector<Item> items;
+		std::vector<int> freeIDs;
+		unsigned int stamp = 0;
+		CellRange cellRange(const Box& box);
+		static inline long long cellKey(int x, int y) { return ((long long)x << 32) | (unsigned int)y; }
+		// add/remove an item to/from every cell it overlaps
+		void link(int id);
+		void unlink(int id);
+	};
+}
\ No newline at end of file
@@ -0,0 +1,65 @@
+#include "input.h"
+#include "tools.h" // for getTime
+
+// input state: constructor
+lgw::InputState::InputState(void) : keys(lgwcon::INPUT_KEY_COUNT, 0), buttons(lgwcon::INPUT_BUTTON_COUNT, 0) {}
+// input state: update the flags of one key or button
+void lgw::InputState::applyAction(unsigned char& flags, int action)
+{
+	if (action == GLFW_PRESS)
+		flags |= HELD | PRESSED;
+	else if (action == GLFW_RELEASE)
+	{
+		flags &= ~HELD;
+		flags |= RELEASED;
+	}
+	// GLFW_REPEAT doesn't change anything
+}
+// input state: apply one event
+void lgw::InputState::apply(const InputEvent& event)
+{
+	switch (event.type)
+	{
+	case InputEvent::KEY:
+		if (valid(event.code))
+			applyAction(keys[event.code], event.action);
+		break;
+	case InputEvent::MOUSE_BUTTON:
+		if (validButton(event.code))
+			applyAction(buttons[event.code], event.action);
+		break;
+	case InputEvent::CURSOR:
+		cursorX = event.x;
+		cursorY = event.y;
+		break;
+	}
+}
+// input state: forget the presses and releases seen so far
+void lgw::InputState::clearEdges(void)
+{
+	for (unsigned char& flags : keys)
+		flags &= HELD;
+	for (unsigned char& flags : buttons)
+		flags &= HELD;
+}
+
+// input queue: constructor
+lgw::InputQueue::InputQueue(void)
+{
+	pending.reserve(lgwcon::INPUT_QUEUE_RESERVE);
+	frameEvents.reserve(lgwcon::INPUT_QUEUE_RESERVE);
+}
+// input queue: queue an event
+void lgw::InputQueue::push(InputEvent::Type type, int code, int action, int mods, double x, double y)
+{
+	pending.push_back({ type, code, action, mods, x, y, getTime() });
+}
+// input queue: apply the events queued since the last update to the state
+void lgw::InputQueue::update(void)
+{
+	current.clearEdges();
+	frameEvents.clear();
+	frameEvents.swap(pending);
+	for (const InputEvent& event : frameEvents)
+		current.apply(event);
+}
\ No newline at end of file
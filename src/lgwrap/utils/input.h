@@ -0,0 +1,86 @@
+#pragma once
+
+#include <vector>
+#include <GLFW/glfw3.h>
+
+// constants
+namespace lgwcon {
+	// number of key codes and mouse buttons GLFW can report
+	const int INPUT_KEY_COUNT = GLFW_KEY_LAST + 1;
+	const int INPUT_BUTTON_COUNT = GLFW_MOUSE_BUTTON_LAST + 1;
+	// events the input queues have room for before they have to grow (queuing an event mustn't allocate in the middle of
+	// a frame)
+	const size_t INPUT_QUEUE_RESERVE = 1024;
+}
+
+namespace lgw {
+	// one input event as reported by a GLFW callback
+	struct InputEvent {
+		enum Type { KEY, MOUSE_BUTTON, CURSOR };
+		Type type;
+		// key code or mouse button
+		int code;
+		// GLFW_PRESS, GLFW_RELEASE or GLFW_REPEAT
+		int action;
+		int mods;
+		// cursor position (CURSOR events only)
+		double x, y;
+		// time the event was received (glfwGetTime)
+		double time;
+	};
+
+	// key and mouse button state built up from events
+	// (presses and releases are remembered until clearEdges, so a tap that starts and ends between two frames or
+	// simulation steps is still seen as pressed)
+	class InputState {
+	public:
+		// constructor
+		InputState(void);
+		// apply one event
+		void apply(const InputEvent& event);
+		// forget the presses and releases seen so far (call at the start of every frame or step)
+		void clearEdges(void);
+		// key is down, or was pressed since clearEdges
+		inline bool held(int key) const { return valid(key) && (keys[key] & (HELD | PRESSED)) != 0; }
+		// key went down since clearEdges
+		inline bool pressed(int key) const { return valid(key) && (keys[key] & PRESSED) != 0; }
+		// key went up since clearEdges
+		inline bool released(int key) const { return valid(key) && (keys[key] & RELEASED) != 0; }
+		// the same for mouse buttons
+		inline bool buttonHeld(int button) const { return validButton(button) && (buttons[button] & (HELD | PRESSED)) != 0; }
+		inline bool buttonPressed(int button) const { return validButton(button) && (buttons[button] & PRESSED) != 0; }
+		inline bool buttonReleased(int button) const { return validButton(button) && (buttons[button] & RELEASED) != 0; }
+		// last cursor position
+		double cursorX = 0.0, cursorY = 0.0;
+	private:
+		static const unsigned char HELD = 1;
+		static const unsigned char PRESSED = 2;
+		static const unsigned char RELEASED = 4;
+		std::vector<unsigned char> keys;
+		std::vector<unsigned char> buttons;
+		static inline bool valid(int key) { return key >= 0 && key < lgwcon::INPUT_KEY_COUNT; }
+		static inline bool validButton(int button) { return button >= 0 && button < lgwcon::INPUT_BUTTON_COUNT; }
+		static void applyAction(unsigned char& flags, int action);
+	};
+
+	// queues GLFW input events with timestamps (fed by the window callbacks) and turns them into an input state once per frame
+	class InputQueue {
+	public:
+		// constructor
+		InputQueue(void);
+		// queue an event (called from the GLFW callbacks on the main thread)
+		void push(InputEvent::Type type, int code, int action, int mods, double x = 0.0, double y = 0.0);
+		// apply the events queued since the last update to the state (call once per frame after polling events)
+		void update(void);
+		// state after the last update
+		inline const InputState& state(void) const { return current; }
+		// events applied by the last update, oldest first
+		inline const std::vector<InputEvent>& events(void) const { return frameEvents; }
+		// the last update had more events than the queues have room for (so queuing them allocated)
+		inline bool overflowed(void) const { return frameEvents.size() > lgwcon::INPUT_QUEUE_RESERVE; }
+	private:
+		std::vector<InputEvent> pending;
+		std::vector<InputEvent> frameEvents;
+		InputState current;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,185 @@
+#include "jobs.h"
+
+#include <algorithm> // for std::min and std::max
+
+namespace {
+	// job system and queue index of the worker running on this thread (workers only)
+	thread_local lgw::JobSystem* workerSystem = nullptr;
+	thread_local int workerQueue = 0;
+}
+
+// job system: constructor
+lgw::JobSystem::JobSystem(void) : queued(0), executedCount(0), stolenCount(0)
+{
+	queues.emplace_back(new Queue());
+}
+// job system: destructor
+lgw::JobSystem::~JobSystem(void)
+{
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		stopping = true;
+	}
+	sleepCondition.notify_all();
+	for (std::thread& thread : threads)
+		thread.join();
+	// without workers, whatever is left is run here
+	while (runOne(0));
+}
+// job system: start the worker threads
+void lgw::JobSystem::init(int numThreads)
+{
+	if (numThreads <= 0)
+		numThreads = std::max(1, (int)std::thread::hardware_concurrency() - 1);
+	// all queues exist before any worker starts stealing from them
+	for (int i = 0; i < numThreads; i++)
+		queues.emplace_back(new Queue());
+	for (int i = 0; i < numThreads; i++)
+		threads.emplace_back(&JobSystem::workerLoop, this, i + 1);
+}
+// job system: index of the queue that belongs to the calling thread
+int lgw::JobSystem::ownQueue(void) const
+{
+	return workerSystem == this ? workerQueue : 0;
+}
+// job system: queue a job
+void lgw::JobSystem::submit(std::function<void(void)> task, JobCounter* counter)
+{
+	if (counter)
+		counter->value++;
+	push({ std::move(task), counter });
+}
+// job system: queue a job once every job counted by 'dependency' has finished
+void lgw::JobSystem::submitAfter(JobCounter& dependency, std::function<void(void)> task, JobCounter* counter)
+{
+	if (counter)
+		counter->value++;
+	{
+		// the count only drops to zero while this mutex is held, so the job can't miss its release
+		std::lock_guard<std::mutex> lock(dependency.waitingMutex);
+		if (dependency.value.load() > 0)
+		{
+			dependency.waiting.push_back({ std::move(task), counter });
+			return;
+		}
+	}
+	push({ std::move(task), counter });
+}
+// job system: push a job onto the calling thread's queue and wake a worker
+void lgw::JobSystem::push(Job job)
+{
+	Queue& queue = *queues[ownQueue()];
+	{
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.jobs.push_back(std::move(job));
+	}
+	queued++;
+	// taking the sleep mutex makes sure a worker that just found nothing to do is either asleep or sees the new job
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+	}
+	sleepCondition.notify_one();
+}
+// job system: take a job from a queue's back or front
+bool lgw::JobSystem::pop(int index, bool front, Job& job)
+{
+	Queue& queue = *queues[index];
+	std::lock_guard<std::mutex> lock(queue.mutex);
+	if (queue.jobs.empty())
+		return false;
+	if (front)
+	{
+		job = std::move(queue.jobs.front());
+		queue.jobs.pop_front();
+	}
+	else
+	{
+		job = std::move(queue.jobs.back());
+		queue.jobs.pop_back();
+	}
+	queued--;
+	return true;
+}
+// job system: run one job from the given queue, or one stolen from another queue
+bool lgw::JobSystem::runOne(int index)
+{
+	Job job;
+	// own work newest first (its data is most likely still in the cache)
+	bool found = pop(index, false, job);
+	// otherwise steal the oldest job of another queue, starting with the next one so thieves spread out
+	for (int i = 1; !found && i < (int)queues.size(); i++)
+	{
+		found = pop((index + i) % queues.size(), true, job);
+		if (found)
+			stolenCount++;
+	}
+	if (!found)
+		return false;
+	job.task();
+	executedCount++;
+	finish(job);
+	return true;
+}
+// job system: decrement the job's counter and release the jobs that waited for it
+void lgw::JobSystem::finish(Job& job)
+{
+	if (!job.counter)
+		return;
+	std::vector<Job> released;
+	{
+		std::lock_guard<std::mutex> lock(job.counter->waitingMutex);
+		if (--job.counter->value == 0)
+			released.swap(job.counter->waiting);
+	}
+	// the counter may be gone from here on
+	for (Job& next : released)
+		push(std::move(next));
+}
+// job system: run jobs on the calling thread until the counter reaches zero
+void lgw::JobSystem::wait(JobCounter& counter)
+{
+	int index = ownQueue();
+	while (counter.value.load() > 0)
+	{
+		if (!runOne(index))
+			std::this_thread::yield();
+	}
+	// the job that finished last may still hold the counter's mutex
+	std::lock_guard<std::mutex> lock(counter.waitingMutex);
+}
+// job system: run body(begin, end) for every range of 'grain' items in parallel and wait
+void lgw::JobSystem::parallelFor(int count, int grain, const std::function<void(int begin, int end)>& body)
+{
+	if (count <= 0)
+		return;
+	grain = std::max(1, grain);
+	if (count <= grain || threads.empty())
+	{
+		body(0, count);
+		return;
+	}
+	JobCounter counter;
+	for (int begin = grain; begin < count; begin += grain)
+	{
+		int end = std::min(count, begin + grain);
+		submit([&body, begin, end] { body(begin, end); }, &counter);
+	}
+	// the calling thread takes the first range itself
+	body(0, grain);
+	wait(counter);
+}
+// job system: run jobs until the job system is destroyed
+void lgw::JobSystem::workerLoop(int index)
+{
+	workerSystem = this;
+	workerQueue = index;
+	while (true)
+	{
+		if (runOne(index))
+			continue;
+		std::unique_lock<std::mutex> lock(sleepMutex);
+		sleepCondition.wait(lock, [this] { return stopping || queued.load() > 0; });
+		if (stopping && queued.load() == 0)
+			return;
+	}
+}
\ No newline at end of file
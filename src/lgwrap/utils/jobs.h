@@ -0,0 +1,91 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace lgw {
+	class JobCounter;
+
+	// unit of work
+	struct Job {
+		std::function<void(void)> task;
+		// counter that is decremented once the job has finished (can be null)
+		JobCounter* counter;
+	};
+
+	// counts unfinished jobs: submitting a job with a counter increments it and finishing the job decrements it
+	// (dependencies are expressed by submitting jobs that wait for a counter to reach zero)
+	class JobCounter {
+	public:
+		inline JobCounter(void) : value(0) {}
+		// number of unfinished jobs
+		inline int get(void) const { return value.load(); }
+	private:
+		friend class JobSystem;
+		std::atomic<int> value;
+		// jobs that are submitted once the counter reaches zero
+		std::mutex waitingMutex;
+		std::vector<Job> waiting;
+	};
+
+	// work-stealing job system: every worker thread owns a deque that it pushes to and pops from at the back, and idle
+	// workers steal from the front of the others' deques (the oldest, usually biggest, jobs); threads that aren't
+	// workers (the main thread) submit into a shared deque and help out with jobs while they wait
+	class JobSystem {
+	public:
+		// constructor
+		JobSystem(void);
+		// destructor (finishes every queued job, then stops the workers)
+		~JobSystem(void);
+		// start the worker threads (0 = one less than the number of hardware threads, at least 1)
+		void init(int numThreads = 0);
+		// queue a job
+		void submit(std::function<void(void)> task, JobCounter* counter = nullptr);
+		// queue a job once every job counted by 'dependency' has finished
+		void submitAfter(JobCounter& dependency, std::function<void(void)> task, JobCounter* counter = nullptr);
+		// run jobs on the calling thread until the counter reaches zero (the counter can be destroyed afterwards)
+		void wait(JobCounter& counter);
+		// split [0, count) into ranges of 'grain' items, run body(begin, end) for each of them in parallel and wait
+		void parallelFor(int count, int grain, const std::function<void(int begin, int end)>& body);
+		// number of worker threads
+		inline int workerCount(void) const { return (int)threads.size(); }
+		// number of jobs run so far and how many of them were stolen from another thread's deque
+		inline long long executed(void) const { return executedCount.load(); }
+		inline long long stolen(void) const { return stolenCount.load(); }
+	private:
+		struct Queue {
+			std::mutex mutex;
+			std::deque<Job> jobs;
+		};
+		// queues[0] is shared by the threads that aren't workers; worker i owns queues[i + 1]
+		std::vector<std::unique_ptr<Queue>> queues;
+		std::vector<std::thread> threads;
+		// number of jobs sitting in the queues
+		std::atomic<int> queued;
+		// idle workers sleep here
+		std::mutex sleepMutex;
+		std::condition_variable sleepCondition;
+		bool stopping = false;
+		// statistics
+		std::atomic<long long> executedCount;
+		std::atomic<long long> stolenCount;
+		// index of the queue that belongs to the calling thread
+		int ownQueue(void) const;
+		// push a job onto the calling thread's queue and wake a worker
+		void push(Job job);
+		// take a job from a queue's back (own work) or front (stealing)
+		bool pop(int queue, bool front, Job& job);
+		// run one job from the given queue, or one stolen from another queue; returns false if there was nothing to do
+		bool runOne(int queue);
+		// decrement the job's counter and release the jobs that waited for it
+		void finish(Job& job);
+		// run jobs until the job system is destroyed
+		void workerLoop(int index);
+	};
+}
\ No newline at end of file
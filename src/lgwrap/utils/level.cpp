@@ -0,0 +1,362 @@
+#include "level.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <map>
+#include <cmath> // for std::floor
+#include <cstring> // for std::memcmp and std::memcpy
+#include <algorithm> // for std::min and std::max
+
+namespace {
+	// size of one array of 'count' 32-bit values, padded to the alignment of the next array (64-bit, so a corrupt count
+	// can't wrap around)
+	uint64_t arraySize(uint32_t count)
+	{
+		uint64_t bytes = (uint64_t)count * 4;
+		return (bytes + lgwcon::LEVEL_ALIGNMENT - 1) / lgwcon::LEVEL_ALIGNMENT * lgwcon::LEVEL_ALIGNMENT;
+	}
+	// number of arrays in a section
+	uint32_t fieldCount(uint32_t type)
+	{
+		switch (type)
+		{
+		case lgw::LevelSection::BARRIERS: return 4;
+		case lgw::LevelSection::TILES: return 5;
+		case lgw::LevelSection::BODIES: return 5;
+		case lgw::LevelSection::SPAWNS: return 3;
+		case lgw::LevelSection::CHUNKS: return 2;
+		default: return 0;
+		}
+	}
+	// point a view of rectangles at a section's arrays
+	void viewRects(const unsigned char* data, const lgw::LevelSection& section, lgw::LevelRects& rects)
+	{
+		size_t stride = (size_t)arraySize(section.count);
+		const unsigned char* base = data + section.offset;
+		rects.count = section.count;
+		rects.x1 = reinterpret_cast<const float*>(base);
+		rects.y1 = reinterpret_cast<const float*>(base + stride);
+		rects.x2 = reinterpret_cast<const float*>(base + stride * 2);
+		rects.y2 = reinterpret_cast<const float*>(base + stride * 3);
+		rects.color = section.type == lgw::LevelSection::BARRIERS ? nullptr : reinterpret_cast<const uint32_t*>(base + stride * 4);
+	}
+	// pack a color into 8 bits per channel
+	uint32_t packColor(const float color[4])
+	{
+		uint32_t packed = 0;
+		for (int i = 0; i < 4; i++)
+			packed |= (uint32_t)(std::min(std::max(color[i], 0.0f), 1.0f) * 255.0f + 0.5f) << (8 * i);
+		return packed;
+	}
+
+	// section being collected by the converter (one vector per array)
+	struct SectionData {
+		uint32_t type;
+		std::vector<std::vector<uint32_t>> fields;
+		SectionData(uint32_t type) : type(type), fields(fieldCount(type)) {}
+		inline uint32_t count(void) const { return (uint32_t)fields[0].size(); }
+		inline void push(int field, float value) { uint32_t bits; std::memcpy(&bits, &value, 4); fields[field].push_back(bits); }
+		inline void push(int field, uint32_t value) { fields[field].push_back(value); }
+		inline void push(int field, int32_t value) { fields[field].push_back((uint32_t)value); }
+	};
+
+	// write a binary level file made of the given sections
+	int writeLevel(const std::string& path, float width, float height, float chunkSize, SectionData* const* sections, int sectionCount)
+	{
+		// lay out the header, the section table and the section data
+		lgw::LevelHeader header;
+		std::memcpy(header.magic, lgwcon::LEVEL_MAGIC, 4);
+		header.version = lgwcon::LEVEL_VERSION;
+		header.sectionCount = (uint32_t)sectionCount;
+		header.width = width;
+		header.height = height;
+		header.chunkSize = chunkSize;
+		header.reserved = 0;
+		std::vector<lgw::LevelSection> table(sectionCount);
+		uint32_t tableEnd = (uint32_t)(sizeof(lgw::LevelHeader) + sizeof(lgw::LevelSection) * sectionCount);
+		uint64_t offset = arraySize(tableEnd / 4);
+		for (int i = 0; i < sectionCount; i++)
+		{
+			table[i].type = sections[i]->type;
+			table[i].count = sections[i]->count();
+			table[i].offset = (uint32_t)offset;
+			table[i].reserved = 0;
+			offset += sections[i]->fields.size() * arraySize(table[i].count);
+		}
+		// offsets in the file are 32-bit
+		if (offset > UINT32_MAX)
+		{
+			std::cout << "level: " << path << " would be bigger than 4 GB" << std::endl;
+			return -1;
+		}
+		header.fileSize = (uint32_t)offset;
+
+		std::ofstream output(path, std::ios::binary | std::ios::trunc);
+		if (!output.is_open())
+		{
+			std::cout << "level: failed to write " << path << std::endl;
+			return -1;
+		}
+		const char padding[lgwcon::LEVEL_ALIGNMENT] = { 0 };
+		output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		output.write(reinterpret_cast<const char*>(table.data()), sizeof(lgw::LevelSection) * sectionCount);
+		output.write(padding, (std::streamsize)(arraySize(tableEnd / 4) - tableEnd));
+		for (int i = 0; i < sectionCount; i++)
+		{
+			for (const std::vector<uint32_t>& field : sections[i]->fields)
+			{
+				output.write(reinterpret_cast<const char*>(field.data()), field.size() * 4);
+				output.write(padding, (std::streamsize)(arraySize((uint32_t)field.size()) - field.size() * 4));
+			}
+		}
+		if (!output)
+		{
+			std::cout << "level: failed to write " << path << std::endl;
+			return -1;
+		}
+		return 0;
+	}
+}
+
+// level rects: unpack the color of element i into four floats
+void lgw::LevelRects::unpackColor(uint32_t i, float out[4]) const
+{
+	uint32_t packed = color != nullptr ? color[i] : 0xffffffff;
+	for (int c = 0; c < 4; c++)
+		out[c] = (float)((packed >> (8 * c)) & 0xff) / 255.0f;
+}
+
+// level: map and validate a binary level file
+int lgw::Level::load(const std::string& path)
+{
+	unload();
+	if (file.open(path))
+	{
+		std::cout << "level: failed to open " << path << std::endl;
+		return -1;
+	}
+	const unsigned char* data = file.data();
+	size_t size = file.size();
+	const LevelHeader* candidate = reinterpret_cast<const LevelHeader*>(data);
+	if (size < sizeof(LevelHeader) || std::memcmp(candidate->magic, lgwcon::LEVEL_MAGIC, 4) != 0)
+	{
+		std::cout << "level: " << path << " is not a level file" << std::endl;
+		file.close();
+		return -1;
+	}
+	if (candidate->version != lgwcon::LEVEL_VERSION)
+	{
+		std::cout << "level: " << path << " has version " << candidate->version << " (expected " << lgwcon::LEVEL_VERSION
+			<< "); convert it again" << std::endl;
+		file.close();
+		return -1;
+	}
+	if (candidate->fileSize != size || sizeof(LevelHeader) + (size_t)candidate->sectionCount * sizeof(LevelSection) > size)
+	{
+		std::cout << "level: " << path << " is truncated" << std::endl;
+		file.close();
+		return -1;
+	}
+
+	// check that every section lies inside the file before handing out pointers into it
+	const LevelSection* sections = reinterpret_cast<const LevelSection*>(data + sizeof(LevelHeader));
+	for (uint32_t i = 0; i < candidate->sectionCount; i++)
+	{
+		const LevelSection& section = sections[i];
+		uint32_t fields = fieldCount(section.type);
+		if (fields == 0)
+			continue; // unknown sections are skipped
+		uint64_t end = (uint64_t)section.offset + fields * arraySize(section.count);
+		if (section.offset % lgwcon::LEVEL_ALIGNMENT != 0 || end > size)
+		{
+			std::cout << "level: " << path << " has a corrupt section table" << std::endl;
+			unload();
+			return -1;
+		}
+		switch (section.type)
+		{
+		case LevelSection::BARRIERS: viewRects(data, section, barriers_); break;
+		case LevelSection::TILES: viewRects(data, section, tiles_); break;
+		case LevelSection::BODIES: viewRects(data, section, bodies_); break;
+		case LevelSection::SPAWNS:
+		{
+			size_t stride = (size_t)arraySize(section.count);
+			spawns_.count = section.count;
+			spawns_.x = reinterpret_cast<const float*>(data + section.offset);
+			spawns_.y = reinterpret_cast<const float*>(data + section.offset + stride);
+			spawns_.kind = reinterpret_cast<const uint32_t*>(data + section.offset + stride * 2);
+			break;
+		}
+		case LevelSection::CHUNKS:
+			chunks_.count = section.count;
+			chunks_.x = reinterpret_cast<const int32_t*>(data + section.offset);
+			chunks_.y = reinterpret_cast<const int32_t*>(data + section.offset + (size_t)arraySize(section.count));
+			break;
+		}
+	}
+	header = candidate;
+	return 0;
+}
+// level: unload the level
+void lgw::Level::unload(void)
+{
+	header = nullptr;
+	barriers_ = LevelRects();
+	tiles_ = LevelRects();
+	bodies_ = LevelRects();
+	spawns_ = LevelSpawns();
+	chunks_ = LevelChunks();
+	file.close();
+}
+// level: find the first spawn point of a kind
+bool lgw::Level::spawn(SpawnKind kind, Point& position) const
+{
+	for (uint32_t i = 0; i < spawns_.count; i++)
+	{
+		if (spawns_.kind[i] == (uint32_t)kind)
+		{
+			position = Point(spawns_.x[i], spawns_.y[i]);
+			return true;
+		}
+	}
+	return false;
+}
+
+// path of the file of chunk (x, y) of a chunked level
+std::string lgw::chunkPath(const std::string& levelPath, int x, int y)
+{
+	size_t extension = levelPath.find_last_of('.');
+	size_t slash = levelPath.find_last_of("/\\");
+	std::string base = (extension != std::string::npos && (slash == std::string::npos || extension > slash)) ? levelPath.substr(0, extension) : levelPath;
+	return base + "." + std::to_string(x) + "_" + std::to_string(y) + ".lvl";
+}
+
+// convert a level from the text format into a binary level file
+int lgw::convertLevel(const std::string& textPath, const std::string& binaryPath)
+{
+	std::ifstream input(textPath);
+	if (!input.is_open())
+	{
+		std::cout << "level: failed to open " << textPath << std::endl;
+		return -1;
+	}
+
+	// read every element into its section
+	float width = 0.0f, height = 0.0f, chunkSize = 0.0f;
+	SectionData barriers(LevelSection::BARRIERS), tiles(LevelSection::TILES), bodies(LevelSection::BODIES), spawns(LevelSection::SPAWNS);
+	std::string line;
+	int lineNumber = 0;
+	int errors = 0;
+	while (std::getline(input, line))
+	{
+		lineNumber++;
+		size_t comment = line.find('#');
+		if (comment != std::string::npos)
+			line.erase(comment);
+		std::istringstream tokens(line);
+		std::string keyword;
+		if (!(tokens >> keyword))
+			continue;
+
+		bool valid = true;
+		if (keyword == "size")
+		{
+			valid = (bool)(tokens >> width >> height) && width > 0.0f && height > 0.0f;
+		}
+		else if (keyword == "chunks")
+		{
+			valid = (bool)(tokens >> chunkSize) && chunkSize > 0.0f;
+		}
+		else if (keyword == "barrier")
+		{
+			float p[4];
+			valid = (bool)(tokens >> p[0] >> p[1] >> p[2] >> p[3]);
+			if (valid)
+			{
+				for (int i = 0; i < 4; i++)
+					barriers.push(i, p[i]);
+			}
+		}
+		else if (keyword == "tile" || keyword == "body")
+		{
+			SectionData& section = keyword == "tile" ? tiles : bodies;
+			float p[4], color[4];
+			valid = (bool)(tokens >> p[0] >> p[1] >> p[2] >> p[3] >> color[0] >> color[1] >> color[2] >> color[3]);
+			if (valid)
+			{
+				// rectangles are stored with p1 as the lower-left corner
+				Box box(Point(p[0], p[1]), Point(p[2], p[3]));
+				section.push(0, box.p1.x);
+				section.push(1, box.p1.y);
+				section.push(2, box.p2.x);
+				section.push(3, box.p2.y);
+				section.push(4, packColor(color));
+			}
+		}
+		else if (keyword == "spawn")
+		{
+			std::string kind;
+			float x, y;
+			valid = (bool)(tokens >> kind >> x >> y) && kind == "player";
+			if (valid)
+			{
+				spawns.push(0, x);
+				spawns.push(1, y);
+				spawns.push(2, (uint32_t)SpawnKind::PLAYER);
+			}
+		}
+		else
+		{
+			valid = false;
+		}
+		std::string rest;
+		if (!valid || tokens >> rest)
+		{
+			std::cout << "level: " << textPath << ":" << lineNumber << ": invalid line '" << line << "'" << std::endl;
+			errors++;
+		}
+	}
+	if (width <= 0.0f || height <= 0.0f)
+	{
+		std::cout << "level: " << textPath << " doesn't set the world size" << std::endl;
+		errors++;
+	}
+	if (errors > 0)
+		return -1;
+
+	// a chunked level moves its tiles into one file per chunk and lists the chunks in the main file instead
+	SectionData chunks(LevelSection::CHUNKS);
+	if (chunkSize > 0.0f)
+	{
+		std::map<std::pair<int, int>, SectionData> chunkTiles;
+		for (uint32_t i = 0; i < tiles.count(); i++)
+		{
+			float x1, y1;
+			std::memcpy(&x1, &tiles.fields[0][i], 4);
+			std::memcpy(&y1, &tiles.fields[1][i], 4);
+			std::pair<int, int> key((int)std::floor(x1 / chunkSize), (int)std::floor(y1 / chunkSize));
+			SectionData& chunk = chunkTiles.emplace(key, SectionData(LevelSection::TILES)).first->second;
+			for (size_t field = 0; field < tiles.fields.size(); field++)
+				chunk.fields[field].push_back(tiles.fields[field][i]);
+		}
+		for (std::pair<const std::pair<int, int>, SectionData>& chunk : chunkTiles)
+		{
+			SectionData* chunkSections[1] = { &chunk.second };
+			if (writeLevel(chunkPath(binaryPath, chunk.first.first, chunk.first.second), width, height, chunkSize, chunkSections, 1))
+				return -1;
+			chunks.push(0, (int32_t)chunk.first.first);
+			chunks.push(1, (int32_t)chunk.first.second);
+		}
+		std::cout << "level: wrote " << chunks.count() << " chunk files" << std::endl;
+	}
+
+	SectionData emptyTiles(LevelSection::TILES);
+	SectionData* sections[5] = { &barriers, chunkSize > 0.0f ? &emptyTiles : &tiles, &bodies, &spawns, &chunks };
+	if (writeLevel(binaryPath, width, height, chunkSize, sections, 5))
+		return -1;
+	std::cout << "level: converted " << textPath << " to " << binaryPath << " (" << barriers.count() << " barriers, " << tiles.count()
+		<< " tiles, " << bodies.count() << " bodies, " << spawns.count() << " spawns)" << std::endl;
+	return 0;
+}
\ No newline at end of file
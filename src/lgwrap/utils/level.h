@@ -0,0 +1,131 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+
+#include "mapped.h"
+#include "../physics/object.h"
+
+// constants
+namespace lgwcon {
+	// first bytes of every binary level file
+	const char LEVEL_MAGIC[4] = { 'L', 'G', 'W', 'L' };
+	// version of the binary level format (files with a different version are rejected and have to be converted again)
+	const uint32_t LEVEL_VERSION = 2;
+	// alignment of every array in a binary level file
+	const uint32_t LEVEL_ALIGNMENT = 16;
+}
+
+namespace lgw {
+	// binary level file layout (little-endian):
+	//   LevelHeader
+	//   LevelSection[sectionCount]
+	//   section data, one array per field in the order listed below, every array starting on a LEVEL_ALIGNMENT boundary
+	//     BARRIERS: float x1[], y1[], x2[], y2[]
+	//     TILES:    float x1[], y1[], x2[], y2[], uint32 color[] (RGBA, 8 bits per channel, red in the lowest byte)
+	//     BODIES:   same fields as TILES
+	//     SPAWNS:   float x[], y[], uint32 kind[]
+	//     CHUNKS:   int32 x[], y[] (chunks that have a chunk file)
+	//
+	// a chunked level keeps its tiles in one file per chunk instead ("<name>.<x>_<y>.lvl" next to "<name>.lvl", in the
+	// same format with only a TILES section) so they can be streamed in around the camera; a tile belongs to the chunk
+	// its lower-left corner lies in
+	struct LevelHeader {
+		char magic[4];
+		uint32_t version;
+		// size of the whole file in bytes
+		uint32_t fileSize;
+		uint32_t sectionCount;
+		// size of the world
+		float width, height;
+		// size of a chunk in the virtual world (0 if the level isn't chunked)
+		float chunkSize;
+		uint32_t reserved;
+	};
+	struct LevelSection {
+		enum Type : uint32_t { BARRIERS = 1, TILES = 2, BODIES = 3, SPAWNS = 4, CHUNKS = 5 };
+		uint32_t type;
+		// number of elements
+		uint32_t count;
+		// offset of the first array from the start of the file
+		uint32_t offset;
+		uint32_t reserved;
+	};
+
+	// kinds of spawn points
+	enum class SpawnKind : uint32_t { PLAYER = 0 };
+
+	// view of a section of rectangles (the arrays point straight into the mapped file)
+	struct LevelRects {
+		uint32_t count = 0;
+		const float* x1 = nullptr;
+		const float* y1 = nullptr;
+		const float* x2 = nullptr;
+		const float* y2 = nullptr;
+		// packed colors (nullptr for barriers)
+		const uint32_t* color = nullptr;
+		// unpack the color of element i into four floats
+		void unpackColor(uint32_t i, float out[4]) const;
+	};
+	// view of the spawn point section
+	struct LevelSpawns {
+		uint32_t count = 0;
+		const float* x = nullptr;
+		const float* y = nullptr;
+		const uint32_t* kind = nullptr;
+	};
+	// view of the chunk section
+	struct LevelChunks {
+		uint32_t count = 0;
+		const int32_t* x = nullptr;
+		const int32_t* y = nullptr;
+	};
+
+	// level loaded from a binary level file
+	// (the file is memory-mapped and used in place: loading only validates the header and the section table, so it
+	// takes the same time for any level size and the level data is never copied)
+	class Level {
+	public:
+		// map and validate a binary level file (returns 0 on success and -1 on failure; the previous level is unloaded)
+		int load(const std::string& path);
+		// unload the level
+		void unload(void);
+		// true if a level is loaded
+		inline bool loaded(void) const { return header != nullptr; }
+		// size of the world
+		inline float width(void) const { return header != nullptr ? header->width : 0.0f; }
+		inline float height(void) const { return header != nullptr ? header->height : 0.0f; }
+		// size of a chunk (0 if the level isn't chunked)
+		inline float chunkSize(void) const { return header != nullptr ? header->chunkSize : 0.0f; }
+		// sections (empty if the level doesn't have them)
+		inline const LevelRects& barriers(void) const { return barriers_; }
+		inline const LevelRects& tiles(void) const { return tiles_; }
+		inline const LevelRects& bodies(void) const { return bodies_; }
+		inline const LevelSpawns& spawns(void) const { return spawns_; }
+		inline const LevelChunks& chunks(void) const { return chunks_; }
+		// find the first spawn point of a kind (returns false if there is none)
+		bool spawn(SpawnKind kind, Point& position) const;
+		// read every page of the file so later accesses don't fault (meant to be called on a worker thread)
+		inline void prefault(void) const { file.prefault(); }
+	private:
+		MappedFile file;
+		const LevelHeader* header = nullptr;
+		LevelRects barriers_, tiles_, bodies_;
+		LevelSpawns spawns_;
+		LevelChunks chunks_;
+	};
+	// path of the file of chunk (x, y) of the chunked level at 'levelPath'
+	std::string chunkPath(const std::string& levelPath, int x, int y);
+
+	// convert a level from the text format into a binary level file (returns 0 on success and -1 on failure)
+	//
+	// text format, one element per line ('#' starts a comment):
+	//   size W H                       size of the world (required)
+	//   barrier X1 Y1 X2 Y2            static line the player and the bodies collide with (if it is horizontal or
+	//                                  vertical; other barriers are only drawn)
+	//   tile X1 Y1 X2 Y2 R G B A       static rectangle (colors from 0 to 1)
+	//   body X1 Y1 X2 Y2 R G B A       dynamic rectangle
+	//   spawn KIND X Y                 spawn point (KIND: player)
+	//   chunks SIZE                    split the tiles into chunk files of SIZE x SIZE (for streaming)
+	int convertLevel(const std::string& textPath, const std::string& binaryPath);
+}
\ No newline at end of file
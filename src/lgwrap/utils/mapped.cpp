@@ -0,0 +1,130 @@
+#include "mapped.h"
+
+#if defined(_WIN32)
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <cerrno>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// mapped file: destructor
+lgw::MappedFile::~MappedFile(void)
+{
+	close();
+}
+// mapped file: touch every page of the mapping
+void lgw::MappedFile::prefault(void) const
+{
+	// a read per 4 KiB is enough on every platform we run on (larger pages are only touched more than once)
+	volatile unsigned char sink = 0;
+	for (size_t offset = 0; offset < size_; offset += 4096)
+		sink += data_[offset];
+}
+
+#if defined(_WIN32)
+// mapped file: map a file
+int lgw::MappedFile::open(const std::string& path)
+{
+	close();
+	HANDLE handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (handle == INVALID_HANDLE_VALUE)
+		return -1;
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(handle, &fileSize) || fileSize.QuadPart == 0)
+	{
+		CloseHandle(handle);
+		return -1;
+	}
+	HANDLE view = CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (view == NULL)
+	{
+		CloseHandle(handle);
+		return -1;
+	}
+	data_ = static_cast<const unsigned char*>(MapViewOfFile(view, FILE_MAP_READ, 0, 0, 0));
+	if (data_ == nullptr)
+	{
+		CloseHandle(view);
+		CloseHandle(handle);
+		return -1;
+	}
+	file = handle;
+	mapping = view;
+	size_ = (size_t)fileSize.QuadPart;
+	return 0;
+}
+// mapped file: unmap the file
+void lgw::MappedFile::close(void)
+{
+	if (data_ != nullptr)
+		UnmapViewOfFile(data_);
+	if (mapping != nullptr)
+		CloseHandle(mapping);
+	if (file != nullptr)
+		CloseHandle(file);
+	data_ = nullptr;
+	size_ = 0;
+	mapping = nullptr;
+	file = nullptr;
+}
+#else
+// mapped file: map a file
+int lgw::MappedFile::open(const std::string& path)
+{
+	close();
+	int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		return -1;
+	struct stat info;
+	if (fstat(fd, &info) != 0 || info.st_size == 0)
+	{
+		::close(fd);
+		return -1;
+	}
+	void* view = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	// the mapping keeps its own reference to the file
+	::close(fd);
+	if (view == MAP_FAILED)
+		return -1;
+	data_ = static_cast<const unsigned char*>(view);
+	size_ = (size_t)info.st_size;
+	return 0;
+}
+// mapped file: unmap the file
+void lgw::MappedFile::close(void)
+{
+	if (data_ != nullptr)
+		munmap(const_cast<unsigned char*>(data_), size_);
+	data_ = nullptr;
+	size_ = 0;
+}
+#endif
+
+// 64-bit FNV-1a hash of a block of memory
+unsigned long long lgw::hashBytes(const void* data, size_t size, unsigned long long hash)
+{
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+// create a directory
+int lgw::createDirectory(const std::string& path)
+{
+#if defined(_WIN32)
+	if (CreateDirectoryA(path.c_str(), NULL) || GetLastError() == ERROR_ALREADY_EXISTS)
+		return 0;
+#else
+	if (mkdir(path.c_str(), 0755) == 0 || errno == EEXIST)
+		return 0;
+#endif
+	return -1;
+}
\ No newline at end of file
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+namespace lgw {
+	// read-only memory mapping of a whole file
+	// (the pages are loaded by the OS on first access and shared with its file cache, so nothing is copied onto the heap)
+	class MappedFile {
+	public:
+		// constructor
+		MappedFile(void) {}
+		// destructor
+		~MappedFile(void);
+		// a mapping can't be shared between objects
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+		// map a file (returns 0 on success and -1 if the file couldn't be opened or mapped; unmaps the previous file)
+		int open(const std::string& path);
+		// unmap the file
+		void close(void);
+		// touch every page of the mapping so it's read from disk now instead of on first access
+		void prefault(void) const;
+		// start and size of the mapping (nullptr and 0 while nothing is mapped)
+		inline const unsigned char* data(void) const { return data_; }
+		inline size_t size(void) const { return size_; }
+	private:
+		const unsigned char* data_ = nullptr;
+		size_t size_ = 0;
+#if defined(_WIN32)
+		// file and file mapping handles
+		void* file = nullptr;
+		void* mapping = nullptr;
+#endif
+	};
+
+	// 64-bit FNV-1a hash of a block of memory (pass the previous result as 'hash' to hash several blocks as one)
+	unsigned long long hashBytes(const void* data, size_t size, unsigned long long hash = 14695981039346656037ULL);
+	// create a directory (returns 0 if it was created or already exists)
+	int createDirectory(const std::string& path);
+}
\ No newline at end of file
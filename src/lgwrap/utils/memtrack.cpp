@@ -0,0 +1,333 @@
+#include "memtrack.h"
+
+#include <atomic>
+#include <new>
+#include <algorithm> // for std::max
+#include <cstdlib> // for std::malloc and std::free
+#include <cassert>
+#include <cstdint> // for uintptr_t
+
+namespace {
+	// counters shared by every thread (atomics with static storage are zeroed before any constructor runs, so
+	// allocations made during static initialization are counted too)
+	struct SharedCounters {
+		std::atomic<long long> allocations;
+		std::atomic<long long> frees;
+		std::atomic<long long> bytes;
+		std::atomic<long long> liveBytes;
+		std::atomic<long long> peakBytes;
+	};
+	// one per tag and one for every tag together
+	SharedCounters shared[(int)lgw::MemTag::COUNT + 1];
+
+	// tag of the calling thread and what it allocated under each tag (the last entry is every tag together)
+	thread_local lgw::MemTag currentTag = lgw::MemTag::OTHER;
+	thread_local long long threadCount[(int)lgw::MemTag::COUNT + 1];
+	thread_local long long threadSize[(int)lgw::MemTag::COUNT + 1];
+}
+
+#ifdef LGW_TRACK_ALLOCS
+namespace {
+	// every tracked block starts with a header that remembers its size and tag (16 bytes keep the block aligned the
+	// way operator new guarantees)
+	struct BlockHeader {
+		size_t size;
+		lgw::MemTag tag;
+	};
+	const size_t HEADER_SIZE = 16;
+	static_assert(sizeof(BlockHeader) <= HEADER_SIZE, "the block header doesn't fit");
+
+	// raise 'peak' to 'value'
+	void raise(std::atomic<long long>& peak, long long value)
+	{
+		long long current = peak.load(std::memory_order_relaxed);
+		while (value > current && !peak.compare_exchange_weak(current, value, std::memory_order_relaxed))
+			;
+	}
+	// count an allocation under the calling thread's tag
+	void countAllocation(size_t size)
+	{
+		const int indices[2] = { (int)currentTag, (int)lgw::MemTag::COUNT };
+		for (int index : indices)
+		{
+			SharedCounters& counters = shared[index];
+			counters.allocations.fetch_add(1, std::memory_order_relaxed);
+			counters.bytes.fetch_add((long long)size, std::memory_order_relaxed);
+			raise(counters.peakBytes, counters.liveBytes.fetch_add((long long)size, std::memory_order_relaxed) + (long long)size);
+			threadCount[index]++;
+			threadSize[index] += (long long)size;
+		}
+	}
+	// count a free (under the tag the block was allocated with, so live bytes don't drift between tags)
+	void countFree(lgw::MemTag tag, size_t size)
+	{
+		const int indices[2] = { (int)tag, (int)lgw::MemTag::COUNT };
+		for (int index : indices)
+		{
+			shared[index].frees.fetch_add(1, std::memory_order_relaxed);
+			shared[index].liveBytes.fetch_sub((long long)size, std::memory_order_relaxed);
+		}
+	}
+	// count an allocation and return the memory after the header
+	void* track(void* block, size_t size)
+	{
+		BlockHeader* header = static_cast<BlockHeader*>(block);
+		header->size = size;
+		header->tag = currentTag;
+		countAllocation(size);
+		return static_cast<char*>(block) + HEADER_SIZE;
+	}
+	// count a free and return the start of the block
+	void* untrack(void* memory)
+	{
+		void* block = static_cast<char*>(memory) - HEADER_SIZE;
+		const BlockHeader* header = static_cast<const BlockHeader*>(block);
+		countFree(header->tag, header->size);
+		return block;
+	}
+	// allocate a tracked block (returns nullptr if the heap is out of memory)
+	void* allocate(size_t size)
+	{
+		void* block = std::malloc(size + HEADER_SIZE);
+		return block != nullptr ? track(block, size) : nullptr;
+	}
+	// free a tracked block
+	void release(void* memory)
+	{
+		if (memory != nullptr)
+			std::free(untrack(memory));
+	}
+
+#ifdef __cpp_aligned_new
+	// over-aligned blocks (C++17 aligned new) are placed inside a bigger block, and their header also remembers where
+	// that block starts
+	struct AlignedHeader {
+		void* block;
+		size_t size;
+		lgw::MemTag tag;
+	};
+	const size_t ALIGNED_HEADER_SIZE = 32;
+	static_assert(sizeof(AlignedHeader) <= ALIGNED_HEADER_SIZE, "the aligned block header doesn't fit");
+
+	// allocate a tracked over-aligned block (returns nullptr if the heap is out of memory)
+	void* allocateAligned(size_t size, size_t alignment)
+	{
+		void* block = std::malloc(size + ALIGNED_HEADER_SIZE + alignment);
+		if (block == nullptr)
+			return nullptr;
+		uintptr_t address = ((uintptr_t)block + ALIGNED_HEADER_SIZE + alignment - 1) / alignment * alignment;
+		AlignedHeader* header = reinterpret_cast<AlignedHeader*>(address - ALIGNED_HEADER_SIZE);
+		header->block = block;
+		header->size = size;
+		header->tag = currentTag;
+		countAllocation(size);
+		return reinterpret_cast<void*>(address);
+	}
+	// free a tracked over-aligned block
+	void releaseAligned(void* memory)
+	{
+		if (memory == nullptr)
+			return;
+		const AlignedHeader* header = reinterpret_cast<const AlignedHeader*>(static_cast<char*>(memory) - ALIGNED_HEADER_SIZE);
+		countFree(header->tag, header->size);
+		std::free(header->block);
+	}
+#endif
+}
+
+// global allocation functions (every other form of new and delete ends up in allocate and release)
+void* operator new(size_t size)
+{
+	void* memory = allocate(size);
+	if (memory == nullptr)
+		throw std::bad_alloc();
+	return memory;
+}
+void* operator new[](size_t size)
+{
+	return operator new(size);
+}
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	return allocate(size);
+}
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+	return allocate(size);
+}
+void operator delete(void* memory) noexcept
+{
+	release(memory);
+}
+void operator delete[](void* memory) noexcept
+{
+	release(memory);
+}
+void operator delete(void* memory, size_t) noexcept
+{
+	release(memory);
+}
+void operator delete[](void* memory, size_t) noexcept
+{
+	release(memory);
+}
+void operator delete(void* memory, const std::nothrow_t&) noexcept
+{
+	release(memory);
+}
+void operator delete[](void* memory, const std::nothrow_t&) noexcept
+{
+	release(memory);
+}
+#ifdef __cpp_aligned_new
+// over-aligned forms (every one ends up in allocateAligned and releaseAligned)
+void* operator new(size_t size, std::align_val_t alignment)
+{
+	void* memory = allocateAligned(size, (size_t)alignment);
+	if (memory == nullptr)
+		throw std::bad_alloc();
+	return memory;
+}
+void* operator new[](size_t size, std::align_val_t alignment)
+{
+	return operator new(size, alignment);
+}
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return allocateAligned(size, (size_t)alignment);
+}
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return allocateAligned(size, (size_t)alignment);
+}
+void operator delete(void* memory, std::align_val_t) noexcept
+{
+	releaseAligned(memory);
+}
+void operator delete[](void* memory, std::align_val_t) noexcept
+{
+	releaseAligned(memory);
+}
+void operator delete(void* memory, size_t, std::align_val_t) noexcept
+{
+	releaseAligned(memory);
+}
+void operator delete[](void* memory, size_t, std::align_val_t) noexcept
+{
+	releaseAligned(memory);
+}
+void operator delete(void* memory, std::align_val_t, const std::nothrow_t&) noexcept
+{
+	releaseAligned(memory);
+}
+void operator delete[](void* memory, std::align_val_t, const std::nothrow_t&) noexcept
+{
+	releaseAligned(memory);
+}
+#endif
+#endif
+
+// memory: name of a tag
+const char* lgw::memTagName(MemTag tag)
+{
+	switch (tag)
+	{
+	case MemTag::OTHER: return "other";
+	case MemTag::RENDER: return "render";
+	case MemTag::TEXT: return "text";
+	case MemTag::PHYSICS: return "physics";
+	case MemTag::SETTINGS: return "settings";
+	default: return "all";
+	}
+}
+// memory: the hooks are compiled in
+bool lgw::memtrack::enabled(void)
+{
+#ifdef LGW_TRACK_ALLOCS
+	return true;
+#else
+	return false;
+#endif
+}
+// memory: counters of a tag over every thread
+lgw::MemCounters lgw::memtrack::counters(MemTag tag)
+{
+	const SharedCounters& source = shared[(int)tag];
+	MemCounters result;
+	result.allocations = source.allocations.load(std::memory_order_relaxed);
+	result.frees = source.frees.load(std::memory_order_relaxed);
+	result.bytes = source.bytes.load(std::memory_order_relaxed);
+	result.liveBytes = source.liveBytes.load(std::memory_order_relaxed);
+	result.peakBytes = source.peakBytes.load(std::memory_order_relaxed);
+	return result;
+}
+// memory: allocations the calling thread made under a tag
+long long lgw::memtrack::threadAllocations(MemTag tag)
+{
+	return threadCount[(int)tag];
+}
+// memory: bytes the calling thread allocated under a tag
+long long lgw::memtrack::threadBytes(MemTag tag)
+{
+	return threadSize[(int)tag];
+}
+
+// memory scope: constructor
+lgw::MemScope::MemScope(MemTag tag) : previous(currentTag)
+{
+	currentTag = tag;
+}
+// memory scope: destructor
+lgw::MemScope::~MemScope(void)
+{
+	currentTag = previous;
+}
+
+// frame allocations: constructor
+lgw::FrameAllocations::FrameAllocations(long long warmup) : warmupFrames(warmup)
+{
+	for (int i = 0; i <= (int)MemTag::COUNT; i++)
+		threadStart[i] = memtrack::threadAllocations((MemTag)i);
+	threadBytesStart = memtrack::threadBytes(MemTag::COUNT);
+	for (int i = 0; i < (int)MemTag::COUNT; i++)
+		tagStart[i] = memtrack::counters((MemTag)i);
+}
+// frame allocations: end the frame
+void lgw::FrameAllocations::frame(void)
+{
+	lastAllocations = memtrack::threadAllocations(MemTag::COUNT) - threadStart[(int)MemTag::COUNT];
+	lastBytes = memtrack::threadBytes(MemTag::COUNT) - threadBytesStart;
+	for (int i = 0; i < (int)MemTag::COUNT; i++)
+	{
+		MemCounters now = memtrack::counters((MemTag)i);
+		tagAllocations[i] = now.allocations - tagStart[i].allocations;
+		tagBytes[i] = now.bytes - tagStart[i].bytes;
+		tagStart[i] = now;
+	}
+	maxAllocations = std::max(maxAllocations, lastAllocations);
+	maxBytes = std::max(maxBytes, lastBytes);
+
+	if (steady() && !allowed && lastAllocations > 0)
+	{
+		// the first one is reported with the tags it allocated under, later ones are only counted
+		if (unexpected == 0)
+		{
+			std::cout << "memory: steady-state frame " << frames << " allocated " << lastAllocations << " times (" << lastBytes << " bytes):";
+			for (int i = 0; i < (int)MemTag::COUNT; i++)
+			{
+				long long count = memtrack::threadAllocations((MemTag)i) - threadStart[i];
+				if (count > 0)
+					std::cout << " " << memTagName((MemTag)i) << " " << count;
+			}
+			std::cout << std::endl;
+		}
+		unexpected++;
+		assert(lastAllocations == 0 && "a steady-state frame allocated");
+	}
+
+	for (int i = 0; i <= (int)MemTag::COUNT; i++)
+		threadStart[i] = memtrack::threadAllocations((MemTag)i);
+	threadBytesStart = memtrack::threadBytes(MemTag::COUNT);
+	frames++;
+	allowed = false;
+}
\ No newline at end of file
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <iostream> // for debug
+#include <cstdint>
+
+// constants
+namespace lgwcon {
+	// frames before a frame loop counts as steady (longer than the profiler's history, so every buffer that's reused
+	// from frame to frame has reached its final size by then)
+	const long long MEMTRACK_WARMUP_FRAMES = 600;
+}
+
+namespace lgw {
+	// subsystems that allocations are counted under
+	enum class MemTag : uint8_t { OTHER, RENDER, TEXT, PHYSICS, SETTINGS, COUNT };
+	// name of a tag
+	const char* memTagName(MemTag tag);
+
+	// allocation counters
+	struct MemCounters {
+		long long allocations = 0; // calls to operator new
+		long long frees = 0; // calls to operator delete
+		long long bytes = 0; // bytes allocated
+		long long liveBytes = 0; // bytes allocated and not freed yet
+		long long peakBytes = 0; // most live bytes at any time
+	};
+
+	// allocation tracking: builds with LGW_TRACK_ALLOCS (the Debug configurations) replace the global operator new and
+	// delete with versions that count every heap allocation under the tag of the thread that made it; other builds
+	// count nothing and every counter stays 0
+	namespace memtrack {
+		// the hooks are compiled in
+		bool enabled(void);
+		// counters of a tag over every thread since the start (MemTag::COUNT gives the sum of every tag)
+		MemCounters counters(MemTag tag);
+		// allocations and bytes the calling thread made under a tag since it started (MemTag::COUNT for every tag)
+		long long threadAllocations(MemTag tag);
+		long long threadBytes(MemTag tag);
+	}
+
+	// tags the allocations the calling thread makes while it's alive (scopes nest, the innermost one wins)
+	class MemScope {
+	public:
+		// constructor
+		explicit MemScope(MemTag tag);
+		// destructor
+		~MemScope(void);
+		MemScope(const MemScope&) = delete;
+		MemScope& operator=(const MemScope&) = delete;
+	private:
+		MemTag previous;
+	};
+
+	// allocations made during each frame of a frame loop; after the warmup the loop is in its steady state, where a
+	// frame shouldn't allocate at all (frames that load or change something call allow): debug builds assert when a
+	// steady frame allocates anyway, release builds count it
+	class FrameAllocations {
+	public:
+		// constructor
+		FrameAllocations(long long warmup = lgwcon::MEMTRACK_WARMUP_FRAMES);
+		// let the current frame allocate
+		inline void allow(void) { allowed = true; }
+		// end the frame (call once per frame on the frame loop's thread)
+		void frame(void);
+		// allocations and bytes of the last frame on the frame loop's thread
+		inline long long allocations(void) const { return lastAllocations; }
+		inline long long bytes(void) const { return lastBytes; }
+		// allocations and bytes of the last frame under a tag, on every thread
+		inline long long allocations(MemTag tag) const { return tagAllocations[(int)tag]; }
+		inline long long bytes(MemTag tag) const { return tagBytes[(int)tag]; }
+		// most allocations and bytes of any frame on the frame loop's thread
+		inline long long peakAllocations(void) const { return maxAllocations; }
+		inline long long peakBytes(void) const { return maxBytes; }
+		// the warmup is over
+		inline bool steady(void) const { return frames >= warmupFrames; }
+		// steady frames that allocated without being allowed to
+		inline long long steadyAllocatingFrames(void) const { return unexpected; }
+	private:
+		long long warmupFrames;
+		long long frames = 0;
+		bool allowed = false;
+		// counters at the end of the last frame
+		long long threadStart[(int)MemTag::COUNT + 1];
+		long long threadBytesStart = 0;
+		MemCounters tagStart[(int)MemTag::COUNT];
+		// results of the last frame
+		long long lastAllocations = 0;
+		long long lastBytes = 0;
+		long long tagAllocations[(int)MemTag::COUNT] = { 0 };
+		long long tagBytes[(int)MemTag::COUNT] = { 0 };
+		long long maxAllocations = 0;
+		long long maxBytes = 0;
+		long long unexpected = 0;
+	};
+}
\ No newline at end of file
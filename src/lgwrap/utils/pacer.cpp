@@ -0,0 +1,152 @@
+#include "pacer.h"
+#include "tools.h" // for getTime
+
+#include <thread> // for std::this_thread::sleep_for
+#include <chrono>
+#include <cmath> // for std::sqrt
+#include <algorithm> // for std::max
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#include <timeapi.h> // for timeBeginPeriod (winmm)
+#endif
+
+// frame pacer: constructor
+lgw::FramePacer::FramePacer(double targetSeconds, double backgroundSeconds)
+	: target(targetSeconds), backgroundTarget(backgroundSeconds), frameStart(getTime())
+{
+	errors.reserve(lgwcon::PACER_HISTORY);
+#ifdef _WIN32
+	// the default scheduler tick on Windows is ~15.6 ms, far too coarse to sleep through a frame
+	timeBeginPeriod(1);
+#endif
+}
+// frame pacer: destructor
+lgw::FramePacer::~FramePacer(void)
+{
+#ifdef _WIN32
+	timeEndPeriod(1);
+#endif
+}
+// frame pacer: change the frame time targets
+void lgw::FramePacer::setTarget(double targetSeconds, double backgroundSeconds)
+{
+	target = targetSeconds;
+	backgroundTarget = backgroundSeconds;
+}
+// frame pacer: turn vsync on or off for the current context
+void lgw::FramePacer::setVsync(bool enabled)
+{
+#ifndef LGW_HEADLESS
+	glfwSwapInterval(enabled ? 1 : 0);
+#endif
+	vsyncEnabled = enabled;
+}
+// frame pacer: wait until the current frame has lasted its target time, then start the next frame
+double lgw::FramePacer::wait(GLFWwindow* window)
+{
+#ifdef LGW_HEADLESS
+	background = false;
+#else
+	background = glfwGetWindowAttrib(window, GLFW_ICONIFIED) || !glfwGetWindowAttrib(window, GLFW_FOCUSED);
+#endif
+	return finish(background ? std::max(target, backgroundTarget) : target, window);
+}
+// frame pacer: wait until the current frame has lasted its target time, without the background throttling
+double lgw::FramePacer::wait(void)
+{
+	background = false;
+	return finish(target, nullptr);
+}
+// frame pacer: sleep until the frame target, then start the next frame
+double lgw::FramePacer::finish(double frameTarget, GLFWwindow* window)
+{
+	if (frameTarget > 0.0)
+	{
+		if (background)
+			waitInBackground(window, frameStart + frameTarget);
+		else
+			sleepUntil(frameStart + frameTarget);
+	}
+
+	double now = getTime();
+	double actual = now - frameStart;
+	frameStart = now;
+	record(actual, frameTarget);
+	return actual;
+}
+// frame pacer: pacing error averaged over the history
+double lgw::FramePacer::averageError(void) const
+{
+	if (errors.empty())
+		return 0.0;
+	double sum = 0.0;
+	for (double error : errors)
+		sum += error;
+	return sum / errors.size();
+}
+// frame pacer: largest pacing error in the history
+double lgw::FramePacer::maxError(void) const
+{
+	double worst = 0.0;
+	for (double error : errors)
+		worst = std::max(worst, error);
+	return worst;
+}
+// frame pacer: sleep in slices while there's clearly enough time left, then spin until the deadline
+void lgw::FramePacer::sleepUntil(double deadline)
+{
+	double now = getTime();
+	while (deadline - now > sleepEstimate)
+	{
+		std::this_thread::sleep_for(std::chrono::microseconds((long long)(lgwcon::PACER_SLEEP_SLICE * 1000000.0)));
+		double after = getTime();
+		double slept = after - now;
+		now = after;
+
+		// learn how long a slice really takes; the estimate keeps two standard deviations of headroom so that
+		// an unusually long sleep rarely runs past the deadline
+		sleepSamples++;
+		double delta = slept - sleepMean;
+		sleepMean += delta / sleepSamples;
+		sleepM2 += delta * (slept - sleepMean);
+		if (sleepSamples > 1)
+			sleepEstimate = sleepMean + 2.0 * std::sqrt(sleepM2 / (sleepSamples - 1));
+	}
+	// the last fraction of a millisecond is spun out
+	while (getTime() < deadline)
+		std::this_thread::yield();
+}
+// frame pacer: wait for events (or the deadline) while the window is unfocused or minimized
+void lgw::FramePacer::waitInBackground(GLFWwindow* window, double deadline)
+{
+#ifdef LGW_HEADLESS
+	// there's no window without GLFW
+	(void)window;
+	sleepUntil(deadline);
+#else
+	double now = getTime();
+	while (now < deadline && !glfwWindowShouldClose(window))
+	{
+		glfwWaitEventsTimeout(deadline - now);
+		// go back to the normal rate as soon as the window is brought back
+		if (!glfwGetWindowAttrib(window, GLFW_ICONIFIED) && glfwGetWindowAttrib(window, GLFW_FOCUSED))
+			break;
+		now = getTime();
+	}
+#endif
+}
+// frame pacer: store the error of the frame that just ended
+void lgw::FramePacer::record(double actual, double frameTarget)
+{
+	double error = frameTarget > 0.0 ? actual - frameTarget : 0.0;
+	if (frameTarget > 0.0 && actual > frameTarget * 1.5)
+		missed++;
+	if (errors.size() < (size_t)lgwcon::PACER_HISTORY)
+		errors.push_back(error);
+	else
+		errors[next] = error;
+	next = (next + 1) % lgwcon::PACER_HISTORY;
+}
\ No newline at end of file
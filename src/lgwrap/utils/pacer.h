@@ -0,0 +1,72 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <GLFW/glfw3.h>
+
+// constants
+namespace lgwcon {
+	// number of frames the pacing error is tracked over
+	const int PACER_HISTORY = 120;
+	// length of one OS sleep slice in seconds
+	const double PACER_SLEEP_SLICE = 0.001;
+	// initial guess of how long a sleep slice really takes (refined while running)
+	const double PACER_SLEEP_ESTIMATE = 0.005;
+}
+
+namespace lgw {
+	// frame pacer: waits for the end of the frame by sleeping for most of the remaining time and spinning only for the last
+	// fraction of a millisecond, throttles the loop while the window is in the background and records how far every frame
+	// was from its target
+	class FramePacer {
+	public:
+		// constructor (a target of 0 or less means uncapped)
+		FramePacer(double targetSeconds, double backgroundSeconds);
+		// destructor
+		~FramePacer(void);
+		// change the frame time targets
+		void setTarget(double targetSeconds, double backgroundSeconds);
+		// turn vsync on or off for the current context
+		void setVsync(bool enabled);
+		// wait until the current frame has lasted its target time, then start the next frame
+		// (returns the actual duration of the frame that just ended)
+		double wait(GLFWwindow* window);
+		// same as above, without the background throttling (for threads other than the main thread, which can't query
+		// the window)
+		double wait(void);
+		// pacing statistics over the last PACER_HISTORY frames (error = actual - target, so late frames are positive)
+		inline double lastError(void) const { return errors.empty() ? 0.0 : errors[(next + errors.size() - 1) % errors.size()]; }
+		double averageError(void) const;
+		double maxError(void) const;
+		// number of frames that took more than 1.5 times their target since the start
+		inline long long missedFrames(void) const { return missed; }
+		// whether vsync is on
+		inline bool vsync(void) const { return vsyncEnabled; }
+		// whether the last frame was throttled because the window was in the background
+		inline bool throttled(void) const { return background; }
+	private:
+		double target;
+		double backgroundTarget;
+		bool vsyncEnabled = false;
+		bool background = false;
+		// time at which the current frame started
+		double frameStart;
+		// ring of the pacing errors of the last frames
+		std::vector<double> errors;
+		size_t next = 0;
+		long long missed = 0;
+		// running mean and variance of the real length of a sleep slice (Welford's method)
+		long long sleepSamples = 0;
+		double sleepMean = 0.0;
+		double sleepM2 = 0.0;
+		double sleepEstimate = lgwcon::PACER_SLEEP_ESTIMATE;
+		// sleep in slices while there's clearly enough time left, then spin until the deadline
+		void sleepUntil(double deadline);
+		// wait for events (or the deadline) while the window is unfocused or minimized
+		void waitInBackground(GLFWwindow* window, double deadline);
+		// sleep until the frame target, then start the next frame
+		double finish(double frameTarget, GLFWwindow* window);
+		// store the error of the frame that just ended
+		void record(double actual, double frameTarget);
+	};
+}
\ No newline at end of file
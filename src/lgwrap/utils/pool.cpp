@@ -0,0 +1,81 @@
+#include "pool.h"
+
+// EntityPool: constructor
+lgw::EntityPool::EntityPool(uint32_t reserved)
+{
+	// the block table itself never has to grow
+	blocks.reserve(lgwcon::ENTITY_MAX / lgwcon::ENTITY_BLOCK_SIZE);
+	reserve(reserved);
+}
+// EntityPool: destructor
+lgw::EntityPool::~EntityPool(void)
+{
+	for (Slot* block : blocks)
+		delete[] block;
+}
+// EntityPool: allocate the blocks for 'count' entities
+void lgw::EntityPool::reserve(uint32_t count)
+{
+	if (count > lgwcon::ENTITY_MAX)
+		count = lgwcon::ENTITY_MAX;
+	while (capacity() < count)
+	{
+		Slot* block = new Slot[lgwcon::ENTITY_BLOCK_SIZE];
+		for (uint32_t i = 0; i < lgwcon::ENTITY_BLOCK_SIZE; i++)
+			block[i] = { 1, lgwcon::ENTITY_NONE, false };
+		blocks.push_back(block);
+	}
+}
+// EntityPool: create an entity
+lgw::Entity lgw::EntityPool::create(void)
+{
+	uint32_t index;
+	if (freeHead != lgwcon::ENTITY_NONE)
+	{
+		index = freeHead;
+		freeHead = slot(index).nextFree;
+	}
+	else
+	{
+		if (usedSlots == lgwcon::ENTITY_MAX)
+		{
+			std::cout << "entities: the pool is full (" << lgwcon::ENTITY_MAX << " entities)" << std::endl;
+			return Entity();
+		}
+		index = usedSlots++;
+		if (index >= capacity())
+			reserve(capacity() + lgwcon::ENTITY_BLOCK_SIZE);
+	}
+	Slot& created = slot(index);
+	created.alive = true;
+	created.nextFree = lgwcon::ENTITY_NONE;
+	aliveCount++;
+	Entity entity;
+	entity.id = (created.generation << lgwcon::ENTITY_INDEX_BITS) | index;
+	return entity;
+}
+// EntityPool: destroy an entity
+bool lgw::EntityPool::destroy(Entity entity)
+{
+	if (!alive(entity))
+		return false;
+	Slot& destroyed = slot(entity.index());
+	destroyed.alive = false;
+	// handles to the old entity stop matching (the generation skips 0 when it wraps around)
+	destroyed.generation = (destroyed.generation + 1) & lgwcon::ENTITY_GENERATION_MASK;
+	if (destroyed.generation == 0)
+		destroyed.generation = 1;
+	destroyed.nextFree = freeHead;
+	freeHead = entity.index();
+	aliveCount--;
+	return true;
+}
+// EntityPool: return true if the handle refers to a living entity
+bool lgw::EntityPool::alive(Entity entity) const
+{
+	uint32_t index = entity.index();
+	if (index >= usedSlots)
+		return false;
+	const Slot& checked = slot(index);
+	return checked.alive && checked.generation == entity.generation();
+}
\ No newline at end of file
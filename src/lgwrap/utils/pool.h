@@ -0,0 +1,142 @@
+#pragma once
+
+#include <iostream> // for debug
+#include <vector>
+#include <cstdint>
+
+// constants
+namespace lgwcon {
+	// number of entity slots allocated at once when the pool grows
+	const uint32_t ENTITY_BLOCK_SIZE = 1024;
+	// bits of an entity handle used for the slot index (the rest hold the generation)
+	const uint32_t ENTITY_INDEX_BITS = 20;
+	const uint32_t ENTITY_INDEX_MASK = (1u << ENTITY_INDEX_BITS) - 1;
+	const uint32_t ENTITY_GENERATION_MASK = (1u << (32 - ENTITY_INDEX_BITS)) - 1;
+	// largest number of entities that can be alive at the same time
+	const uint32_t ENTITY_MAX = ENTITY_INDEX_MASK + 1;
+	// marks an empty slot in free lists and sparse arrays
+	const uint32_t ENTITY_NONE = 0xFFFFFFFF;
+}
+
+namespace lgw {
+	// 32-bit generational handle (slot index in the low bits, generation of the slot in the high bits); a handle to a
+	// despawned entity stays invalid even after its slot is reused, and the zero handle is never valid
+	struct Entity {
+		uint32_t id = 0;
+		inline uint32_t index(void) const { return id & lgwcon::ENTITY_INDEX_MASK; }
+		inline uint32_t generation(void) const { return id >> lgwcon::ENTITY_INDEX_BITS; }
+		inline bool operator==(const Entity& other) const { return id == other.id; }
+		inline bool operator!=(const Entity& other) const { return id != other.id; }
+	};
+
+	// hands out entity handles from fixed-capacity blocks of slots (despawned slots go on a free list and are reused
+	// first, so once the pool has grown to its peak size creating and destroying entities never allocates)
+	class EntityPool {
+	public:
+		// constructor (allocates the blocks for 'reserved' entities up front)
+		EntityPool(uint32_t reserved = 0);
+		// destructor
+		~EntityPool(void);
+		// the blocks are owned by the pool
+		EntityPool(const EntityPool&) = delete;
+		EntityPool& operator=(const EntityPool&) = delete;
+		// allocate the blocks for 'count' entities
+		void reserve(uint32_t count);
+		// create an entity (returns the zero handle if ENTITY_MAX entities are alive)
+		Entity create(void);
+		// destroy an entity (returns false if the handle was already invalid)
+		bool destroy(Entity entity);
+		// return true if the handle refers to a living entity
+		bool alive(Entity entity) const;
+		// number of living entities
+		inline uint32_t size(void) const { return aliveCount; }
+		// number of slots in the allocated blocks
+		inline uint32_t capacity(void) const { return (uint32_t)blocks.size() * lgwcon::ENTITY_BLOCK_SIZE; }
+	private:
+		struct Slot {
+			// generation of the slot's current (or next) entity; starts at 1, so the zero handle is never valid
+			uint32_t generation;
+			// next free slot while the slot is on the free list
+			uint32_t nextFree;
+			bool alive;
+		};
+		std::vector<Slot*> blocks;
+		// slots that were handed out at least once
+		uint32_t usedSlots = 0;
+		// first slot of the free list
+		uint32_t freeHead = lgwcon::ENTITY_NONE;
+		uint32_t aliveCount = 0;
+		inline Slot& slot(uint32_t index) { return blocks[index / lgwcon::ENTITY_BLOCK_SIZE][index % lgwcon::ENTITY_BLOCK_SIZE]; }
+		inline const Slot& slot(uint32_t index) const { return blocks[index / lgwcon::ENTITY_BLOCK_SIZE][index % lgwcon::ENTITY_BLOCK_SIZE]; }
+	};
+
+	// one component type stored densely (values sit next to each other in memory in no particular order, so systems
+	// iterate a plain array; removing swaps the last value into the hole)
+	template <typename T>
+	class ComponentArray {
+	public:
+		// make room for the components of 'count' entities (with entity indices below 'count'), so adding them doesn't
+		// allocate
+		inline void reserve(uint32_t count)
+		{
+			values.reserve(count);
+			owners.reserve(count);
+			if (sparse.size() < count)
+				sparse.resize(count, lgwcon::ENTITY_NONE);
+		}
+		// add the component to an entity (or overwrite the one it already has)
+		inline T& add(Entity entity, const T& value = T())
+		{
+			uint32_t index = entity.index();
+			if (index >= sparse.size())
+				sparse.resize(index + 1, lgwcon::ENTITY_NONE);
+			if (sparse[index] != lgwcon::ENTITY_NONE)
+			{
+				owners[sparse[index]] = entity;
+				return values[sparse[index]] = value;
+			}
+			sparse[index] = (uint32_t)values.size();
+			values.push_back(value);
+			owners.push_back(entity);
+			return values.back();
+		}
+		// remove the component from an entity (returns false if it doesn't have one)
+		inline bool remove(Entity entity)
+		{
+			if (!has(entity))
+				return false;
+			uint32_t hole = sparse[entity.index()];
+			uint32_t last = (uint32_t)values.size() - 1;
+			if (hole != last)
+			{
+				values[hole] = values[last];
+				owners[hole] = owners[last];
+				sparse[owners[hole].index()] = hole;
+			}
+			values.pop_back();
+			owners.pop_back();
+			sparse[entity.index()] = lgwcon::ENTITY_NONE;
+			return true;
+		}
+		// return true if the entity has the component
+		inline bool has(Entity entity) const
+		{
+			uint32_t index = entity.index();
+			return index < sparse.size() && sparse[index] != lgwcon::ENTITY_NONE && owners[sparse[index]] == entity;
+		}
+		// component of an entity (nullptr if it doesn't have one)
+		inline T* get(Entity entity) { return has(entity) ? &values[sparse[entity.index()]] : nullptr; }
+		inline const T* get(Entity entity) const { return has(entity) ? &values[sparse[entity.index()]] : nullptr; }
+		// dense access (for systems that run over every component)
+		inline uint32_t size(void) const { return (uint32_t)values.size(); }
+		inline T& operator[](uint32_t i) { return values[i]; }
+		inline const T& operator[](uint32_t i) const { return values[i]; }
+		inline Entity owner(uint32_t i) const { return owners[i]; }
+	private:
+		// components and the entities they belong to, in the same order
+		std::vector<T> values;
+		std::vector<Entity> owners;
+		// entity index -> position in 'values' (ENTITY_NONE if the entity doesn't have the component)
+		std::vector<uint32_t> sparse;
+	};
+}
\ No newline at end of file
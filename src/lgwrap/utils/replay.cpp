@@ -0,0 +1,176 @@
+#include "replay.h"
+
+#include <cstring> // for std::memcmp and std::memcpy
+
+// replay writer: create the file
+int lgw::ReplayWriter::open(const std::string& path, const std::string& level, const int* keys, uint32_t keyCount)
+{
+	if (keyCount > lgwcon::REPLAY_MAX_KEYS)
+	{
+		std::cout << "replay: can't record more than " << lgwcon::REPLAY_MAX_KEYS << " keys" << std::endl;
+		return -1;
+	}
+	file.open(path, std::ios::binary | std::ios::trunc);
+	if (!file.is_open())
+	{
+		std::cout << "replay: failed to write " << path << std::endl;
+		return -1;
+	}
+	ReplayHeader header;
+	std::memcpy(header.magic, lgwcon::REPLAY_MAGIC, 4);
+	header.version = lgwcon::REPLAY_VERSION;
+	header.levelLength = (uint32_t)level.size();
+	header.keyCount = keyCount;
+	write(header);
+	file.write(level.data(), level.size());
+	keyCodes.assign(keys, keys + keyCount);
+	for (int key : keyCodes)
+		write((int32_t)key);
+	lastErrorMargin = -1.0f;
+	lastMaxSubsteps = -1;
+	return file ? 0 : -1;
+}
+// replay writer: record the settings the next steps use
+void lgw::ReplayWriter::tune(float errorMargin, int maxSubsteps)
+{
+	if (errorMargin == lastErrorMargin && maxSubsteps == lastMaxSubsteps)
+		return;
+	lastErrorMargin = errorMargin;
+	lastMaxSubsteps = maxSubsteps;
+	write(ReplayRecord::TUNE);
+	write(errorMargin);
+	write((int32_t)maxSubsteps);
+}
+// replay writer: record the keys held during a step and its step time
+void lgw::ReplayWriter::step(const InputState& state, float timeElapsed)
+{
+	uint32_t keys = 0;
+	for (size_t i = 0; i < keyCodes.size(); i++)
+	{
+		if (state.held(keyCodes[i]))
+			keys |= 1u << i;
+	}
+	write(ReplayRecord::STEP);
+	write(keys);
+	write(timeElapsed);
+}
+// replay writer: record the state hash after a step
+void lgw::ReplayWriter::checkpoint(long long step, unsigned long long hash)
+{
+	write(ReplayRecord::CHECKPOINT);
+	write((int64_t)step);
+	write((uint64_t)hash);
+}
+// replay writer: write the END record and close the file
+int lgw::ReplayWriter::close(long long step, unsigned long long hash)
+{
+	if (!file.is_open())
+		return -1;
+	write(ReplayRecord::END);
+	write((int64_t)step);
+	write((uint64_t)hash);
+	bool written = (bool)file;
+	file.close();
+	return written ? 0 : -1;
+}
+
+// replay reader: take a field
+template <typename T>
+bool lgw::ReplayReader::read(T& value)
+{
+	if (offset + sizeof(T) > file.size())
+		return false;
+	std::memcpy(&value, file.data() + offset, sizeof(T));
+	offset += sizeof(T);
+	return true;
+}
+// replay reader: map the file and check its header
+int lgw::ReplayReader::open(const std::string& path)
+{
+	offset = 0;
+	finished = false;
+	cut = false;
+	if (file.open(path))
+	{
+		std::cout << "replay: failed to open " << path << std::endl;
+		return -1;
+	}
+	ReplayHeader header;
+	if (!read(header) || std::memcmp(header.magic, lgwcon::REPLAY_MAGIC, 4) != 0)
+	{
+		std::cout << "replay: " << path << " is not a replay file" << std::endl;
+		return -1;
+	}
+	if (header.version != lgwcon::REPLAY_VERSION)
+	{
+		std::cout << "replay: " << path << " has version " << header.version << " (expected " << lgwcon::REPLAY_VERSION << ")" << std::endl;
+		return -1;
+	}
+	if (header.keyCount > lgwcon::REPLAY_MAX_KEYS || offset + header.levelLength + header.keyCount * 4 > file.size())
+	{
+		std::cout << "replay: " << path << " is damaged" << std::endl;
+		return -1;
+	}
+	levelPath.assign(reinterpret_cast<const char*>(file.data() + offset), header.levelLength);
+	offset += header.levelLength;
+	keyCodes.resize(header.keyCount);
+	for (uint32_t i = 0; i < header.keyCount; i++)
+	{
+		int32_t key = 0;
+		read(key);
+		keyCodes[i] = key;
+	}
+	return 0;
+}
+// replay reader: read the next record
+bool lgw::ReplayReader::next(ReplayRecord& record)
+{
+	if (finished)
+		return false;
+	uint8_t type;
+	bool complete = read(type);
+	if (complete)
+	{
+		record.type = (ReplayRecord::Type)type;
+		switch (type)
+		{
+		case ReplayRecord::STEP:
+			complete = read(record.keys) && read(record.timeElapsed);
+			break;
+		case ReplayRecord::TUNE:
+			complete = read(record.errorMargin) && read(record.maxSubsteps);
+			break;
+		case ReplayRecord::CHECKPOINT:
+		case ReplayRecord::END:
+		{
+			int64_t step = 0;
+			uint64_t hash = 0;
+			complete = read(step) && read(hash);
+			record.step = step;
+			record.hash = hash;
+			break;
+		}
+		default:
+			complete = false;
+			break;
+		}
+	}
+	if (!complete)
+	{
+		cut = true;
+		finished = true;
+		return false;
+	}
+	finished = record.type == ReplayRecord::END;
+	return true;
+}
+// replay reader: turn a STEP record's key mask into an input state
+void lgw::ReplayReader::apply(uint32_t keys, InputState& state) const
+{
+	state.clearEdges();
+	for (size_t i = 0; i < keyCodes.size(); i++)
+	{
+		InputEvent event = { InputEvent::KEY, keyCodes[i], (keys & (1u << i)) != 0 ? GLFW_PRESS : GLFW_RELEASE, 0, 0.0, 0.0, 0.0 };
+		state.apply(event);
+	}
+}
\ No newline at end of file
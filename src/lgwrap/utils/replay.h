@@ -0,0 +1,108 @@
+#pragma once
+
+#include <iostream> // for debug
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "input.h"
+#include "mapped.h"
+
+// constants
+namespace lgwcon {
+	// first bytes of every replay file
+	const char REPLAY_MAGIC[4] = { 'L', 'G', 'W', 'R' };
+	// version of the replay format (files with a different version are rejected)
+	const uint32_t REPLAY_VERSION = 1;
+	// most keys a replay can record (one bit each)
+	const uint32_t REPLAY_MAX_KEYS = 32;
+	// number of steps between two state hashes in a replay
+	const long long REPLAY_CHECKPOINT_INTERVAL = 60;
+}
+
+namespace lgw {
+	// replay file layout (little-endian):
+	//   ReplayHeader
+	//   char level[levelLength] (path of the level the session played)
+	//   int32 keys[keyCount] (key codes of the recorded keys, bit i of a step's key mask is keys[i])
+	//   records, each a one-byte type followed by its fields:
+	//     STEP:       uint32 key mask (keys held during the step), float step time
+	//     TUNE:       float physics error margin, int32 substep limit (written before the first step and on every change)
+	//     CHECKPOINT: int64 step number, uint64 state hash
+	//     END:        int64 step number, uint64 state hash (last record)
+	struct ReplayHeader {
+		char magic[4];
+		uint32_t version;
+		uint32_t levelLength;
+		uint32_t keyCount;
+	};
+
+	// one record of a replay
+	struct ReplayRecord {
+		enum Type : uint8_t { STEP = 1, TUNE = 2, CHECKPOINT = 3, END = 4 };
+		Type type;
+		// STEP
+		uint32_t keys;
+		float timeElapsed;
+		// TUNE
+		float errorMargin;
+		int32_t maxSubsteps;
+		// CHECKPOINT and END
+		long long step;
+		unsigned long long hash;
+	};
+
+	// records the input and the step time of every simulation step into a replay file
+	class ReplayWriter {
+	public:
+		// create the file (returns 0 on success and -1 if it couldn't be written)
+		int open(const std::string& path, const std::string& level, const int* keys, uint32_t keyCount);
+		// record the settings the next steps use (only written if they changed)
+		void tune(float errorMargin, int maxSubsteps);
+		// record the keys held during a step and its step time
+		void step(const InputState& state, float timeElapsed);
+		// record the state hash after a step
+		void checkpoint(long long step, unsigned long long hash);
+		// write the END record and close the file (returns -1 if anything failed to be written; a file that isn't closed
+		// has no END record and is rejected as truncated)
+		int close(long long step, unsigned long long hash);
+		inline bool isOpen(void) const { return file.is_open(); }
+	private:
+		std::ofstream file;
+		std::vector<int> keyCodes;
+		// settings written by the last TUNE record
+		float lastErrorMargin = -1.0f;
+		int lastMaxSubsteps = -1;
+		// append a field
+		template <typename T>
+		inline void write(const T& value) { file.write(reinterpret_cast<const char*>(&value), sizeof(T)); }
+	};
+
+	// reads the records of a replay file (mapped, so a replay runs straight from the file cache)
+	class ReplayReader {
+	public:
+		// map the file and check its header (returns 0 on success and -1 if it's missing or invalid)
+		int open(const std::string& path);
+		// level the session played
+		inline const std::string& level(void) const { return levelPath; }
+		// key codes of the recorded keys (bit i of a key mask stands for keys()[i])
+		inline const std::vector<int>& keys(void) const { return keyCodes; }
+		// read the next record (returns false after the END record, or if the file is truncated)
+		bool next(ReplayRecord& record);
+		// the file ended without an END record
+		inline bool truncated(void) const { return cut; }
+		// turn a STEP record's key mask into an input state (the recorded keys are held, every other one is up)
+		void apply(uint32_t keys, InputState& state) const;
+	private:
+		MappedFile file;
+		std::string levelPath;
+		std::vector<int> keyCodes;
+		size_t offset = 0;
+		bool finished = false;
+		bool cut = false;
+		// take a field (returns false if the file ends first)
+		template <typename T>
+		bool read(T& value);
+	};
+}
\ No newline at end of file
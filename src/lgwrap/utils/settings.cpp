@@ -1,122 +1,201 @@
 #include "settings.h"
+#include "memtrack.h"
+
+#include <iterator> // for std::istreambuf_iterator
+#include <cstdlib> // for std::strtol and std::strtod
+#include <cerrno>
+#include <algorithm> // for std::min and std::max
+
+namespace {
+    // remove whitespace from both ends of [begin, end)
+    void trim(const char*& begin, const char*& end)
+    {
+        while (begin < end && (*begin == ' ' || *begin == '\t'))
+            begin++;
+        while (end > begin && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r'))
+            end--;
+    }
+}
 
 // Settings: constructor
-lgw::Settings::Settings(const char* fileDir) : dir(fileDir) {}
-// Settings: reload derived settings
-void lgw::Settings::reload_derived(void)
+lgw::Settings::Settings(const char* fileDir) : dir(fileDir), watcher(fileDir)
 {
-    window_width = window_aspect_ratio_x * window_scale;
-    window_height = window_aspect_ratio_y * window_scale;
-    window_aspect_ratio_dec = (float)window_aspect_ratio_x / (float)window_aspect_ratio_y;
-    spf_cap = 1.0f / fps_cap;
-    window_virtual_width = window_aspect_ratio_dec * inv_scale_factor;
-    window_virtual_height = inv_scale_factor;
+    MemScope memScope(MemTag::SETTINGS);
+    define("window_title", window_title, "2D Physics Game");
+    define("shader_dir", shader_dir, "data/shaders/");
+    define("cache_dir", cache_dir, "data/cache/");
+    define("asset_dir", asset_dir, "data/assets/");
+    define("font_dir", font_dir, "C:/Windows/Fonts/segoeui.ttf");
+    define("level_dir", level_dir, "data/levels/start.lvl");
+    define("window_aspect_ratio_x", window_aspect_ratio_x, 16, 1, 256);
+    define("window_aspect_ratio_y", window_aspect_ratio_y, 9, 1, 256);
+    define("window_scale", window_scale, 100, 1, 1000);
+    define("vsync", vsync, 0, 0, 1);
+    define("fps_cap", fps_cap, 60.0f, 0.0f, 10000.0f);
+    define("inv_scale_factor", inv_scale_factor, 10.0f, 0.1f, 10000.0f);
+    define("physics_error_margin", physics_error_margin, 0.0001f, 0.0f, 1.0f);
+    define("physics_max_substeps", physics_max_substeps, 8, 1, 64);
+    define("camera_position_x", camera_position_x, 0.0f, -1000000.0f, 1000000.0f);
+    define("camera_position_y", camera_position_y, 0.0f, -1000000.0f, 1000000.0f);
+    define("background_fps_cap", background_fps_cap, 10.0f, 0.0f, 10000.0f);
+    define("level_stream_radius", level_stream_radius, 48.0f, 1.0f, 100000.0f);
+    reload_derived();
 }
-// Settings: load settings from a specified directory
-int lgw::Settings::load(void)
+// Settings: add a string setting to the schema
+void lgw::Settings::define(const char* name, std::string& value, const char* defaultValue)
+{
+    index[name] = (int)entries.size();
+    entries.push_back({ name, Type::STRING, &value, defaultValue, 0.0, 0.0, "", {} });
+    value = defaultValue;
+}
+// Settings: add an integer setting to the schema
+void lgw::Settings::define(const char* name, int& value, int defaultValue, int min, int max)
+{
+    index[name] = (int)entries.size();
+    entries.push_back({ name, Type::INT, &value, std::to_string(defaultValue), (double)min, (double)max, "", {} });
+    value = defaultValue;
+}
+// Settings: add a float setting to the schema
+void lgw::Settings::define(const char* name, float& value, float defaultValue, float min, float max)
+{
+    index[name] = (int)entries.size();
+    std::ostringstream text;
+    text << defaultValue;
+    entries.push_back({ name, Type::FLOAT, &value, text.str(), (double)min, (double)max, "", {} });
+    value = defaultValue;
+}
+// Settings: parse a value into an entry's member
+bool lgw::Settings::assign(Entry& entry, const std::string& text)
 {
-    std::ifstream settingsFile(dir);
+    if (entry.type == Type::STRING)
+    {
+        *static_cast<std::string*>(entry.value) = text;
+        return true;
+    }
+
+    // numbers: the whole text has to be consumed and in range of the type
+    const char* begin = text.c_str();
+    char* end = nullptr;
+    errno = 0;
+    double number = entry.type == Type::INT ? (double)std::strtol(begin, &end, 10) : std::strtod(begin, &end);
+    if (end == begin || *end != '\0' || errno == ERANGE)
+    {
+        std::cout << "settings: invalid value '" << text << "' for " << entry.name << std::endl;
+        return false;
+    }
+    if (number < entry.min || number > entry.max)
+    {
+        std::cout << "settings: " << entry.name << " = " << text << " is out of range [" << entry.min << ", " << entry.max << "]; clamped" << std::endl;
+        number = std::min(std::max(number, entry.min), entry.max);
+    }
+    if (entry.type == Type::INT)
+        *static_cast<int*>(entry.value) = (int)number;
+    else
+        *static_cast<float*>(entry.value) = (float)number;
+    return true;
+}
+// Settings: read the file and apply every value whose text differs from the last time
+int lgw::Settings::parse(std::vector<int>* changed)
+{
+    std::ifstream settingsFile(dir, std::ios::binary);
     if (!settingsFile.is_open())
     {
         return -1; // settings file was not found
     }
-    bool stringNamesFound[numStringValues] = { false };
-    bool intNamesFound[numIntValues] = { false };
-    bool floatNamesFound[numFloatValues] = { false };
-    bool found = false;
-    std::string line;
-    while (std::getline(settingsFile, line))
+    std::string data((std::istreambuf_iterator<char>(settingsFile)), std::istreambuf_iterator<char>());
+    settingsFile.close();
+
+    // single pass over the lines: "name = value", blank lines and lines starting with '#' are skipped
+    int count = 0;
+    const char* cursor = data.c_str();
+    const char* fileEnd = cursor + data.size();
+    int lineNumber = 0;
+    // line each setting was last seen on, and whether it was already counted as changed
+    std::vector<int> seenOn(entries.size(), 0);
+    std::vector<bool> counted(entries.size(), false);
+    while (cursor < fileEnd)
     {
-        for (int i = 0; i < numStringValues; i++)
-        {
-            if (!stringNamesFound[i] && !line.find(stringNames[i]))
-            {
-                std::istringstream value(line.substr(line.find("=") + 2));
-                stringValues[i] = value.str();
-                stringNamesFound[i] = true;
-                found = true;
-                break;
-            }
-        }
-        if (found)
-        {
-            found = false;
+        const char* lineEnd = cursor;
+        while (lineEnd < fileEnd && *lineEnd != '\n')
+            lineEnd++;
+        const char* begin = cursor;
+        const char* end = lineEnd;
+        cursor = lineEnd + 1;
+        lineNumber++;
+
+        trim(begin, end);
+        if (begin == end || *begin == '#')
             continue;
-        }
-        for (int i = 0; i < numIntValues; i++)
-        {
-            if (!intNamesFound[i] && !line.find(intNames[i]))
-            {
-                std::istringstream value(line.substr(line.find("=") + 2));
-                intValues[i] = std::stoi(value.str());
-                intNamesFound[i] = true;
-                found = true;
-                break;
-            }
-        }
-        if (found)
+        const char* equals = begin;
+        while (equals < end && *equals != '=')
+            equals++;
+        if (equals == end)
         {
-            found = false;
+            std::cout << "settings: line " << lineNumber << " is not 'name = value'" << std::endl;
             continue;
         }
-        for (int i = 0; i < numFloatValues; i++)
-        {
-            if (!floatNamesFound[i] && !line.find(floatNames[i]))
-            {
-                std::istringstream value(line.substr(line.find("=") + 2));
-                floatValues[i] = std::stof(value.str());
-                floatNamesFound[i] = true;
-                break;
-            }
-        }
-    }
-    // check for missing settings
-    for (int i = 0; i < numStringValues; i++)
-    {
-        if (stringNamesFound[i] == false)
+        const char* nameBegin = begin;
+        const char* nameEnd = equals;
+        const char* valueBegin = equals + 1;
+        const char* valueEnd = end;
+        trim(nameBegin, nameEnd);
+        trim(valueBegin, valueEnd);
+
+        std::unordered_map<std::string, int>::iterator found = index.find(std::string(nameBegin, nameEnd));
+        if (found == index.end())
         {
-            return -i - 2; // missing string in settings file
+            std::cout << "settings: unknown setting '" << std::string(nameBegin, nameEnd) << "' on line " << lineNumber << std::endl;
+            continue;
         }
+        Entry& entry = entries[found->second];
+        if (seenOn[found->second] != 0)
+            std::cout << "settings: '" << entry.name << "' on line " << lineNumber << " was already set on line "
+                << seenOn[found->second] << " (the last one is used)" << std::endl;
+        seenOn[found->second] = lineNumber;
+        std::string value(valueBegin, valueEnd);
+        // values that weren't touched in the file keep whatever they were changed to at runtime
+        if (value == entry.loaded)
+            continue;
+        entry.loaded = value;
+        if (!assign(entry, value))
+            continue;
+        // a setting that's set twice is still one change (so its hooks run once)
+        if (counted[found->second])
+            continue;
+        counted[found->second] = true;
+        count++;
+        if (changed)
+            changed->push_back(found->second);
     }
-    for (int i = 0; i < numIntValues; i++)
+    return count;
+}
+// Settings: reload derived settings
+void lgw::Settings::reload_derived(void)
+{
+    window_width = window_aspect_ratio_x * window_scale;
+    window_height = window_aspect_ratio_y * window_scale;
+    window_aspect_ratio_dec = (float)window_aspect_ratio_x / (float)window_aspect_ratio_y;
+    spf_cap = fps_cap > 0.0f ? 1.0f / fps_cap : 0.0f; // 0 = uncapped
+    spf_background_cap = background_fps_cap > 0.0f ? 1.0f / background_fps_cap : 0.0f;
+    window_virtual_width = window_aspect_ratio_dec * inv_scale_factor;
+    window_virtual_height = inv_scale_factor;
+}
+// Settings: load settings from a specified directory
+int lgw::Settings::load(void)
+{
+    MemScope memScope(MemTag::SETTINGS);
+    if (parse(nullptr) < 0)
     {
-        if (intNamesFound[i] == false)
-        {
-            return -i - 2 - numStringValues; // missing integer in settings file
-        }
+        return -1; // settings file was not found
     }
-    for (int i = 0; i < numFloatValues; i++)
+    // report settings that fell back to their defaults
+    for (Entry& entry : entries)
     {
-        if (floatNamesFound[i] == false)
-        {
-            return -i - 2 - numStringValues - numIntValues; // missing float in settings file
-        }
+        if (entry.loaded.empty())
+            std::cout << "settings: " << entry.name << " not found in settings file; using " << entry.defaultValue << std::endl;
     }
     // derive other settings
     reload_derived();
-    settingsFile.close();
-
-    // debug
-    /*
-    std::cout << "window_title: " << window_title << std::endl;
-    std::cout << "shader_dir: " << shader_dir << std::endl;
-    std::cout << "asset_dir: " << asset_dir << std::endl;
-    std::cout << "font_dir: " << font_dir << std::endl;
-    std::cout << "window_aspect_ratio_x: " << window_aspect_ratio_x << std::endl;
-    std::cout << "window_aspect_ratio_y: " << window_aspect_ratio_y << std::endl;
-    std::cout << "window_scale: " << window_scale << std::endl;
-    std::cout << "fps_cap: " << fps_cap << std::endl;
-    std::cout << "inv_scale_factor: " << inv_scale_factor << std::endl;
-    std::cout << "physics_error_margin: " << physics_error_margin << std::endl;
-    std::cout << "camera_position_x: " << camera_position_x << std::endl;
-    std::cout << "camera_position_y: " << camera_position_y << std::endl;
-    std::cout << "window_width: " << window_width << std::endl;
-    std::cout << "window_height: " << window_height << std::endl;
-    std::cout << "window_aspect_ratio_dec: " << window_aspect_ratio_dec << std::endl;
-    std::cout << "spf_cap: " << spf_cap << std::endl;
-    std::cout << "window_virtual_width: " << window_virtual_width << std::endl;
-    std::cout << "window_virtual_height: " << window_virtual_height << std::endl;
-    */
     return 1;
 }
 // Settings: save current settings to a specified directory
@@ -127,18 +206,53 @@ bool lgw::Settings::save(void)
     {
         return 0;
     }
-    for (int i = 0; i < numStringValues; i++)
+    for (Entry& entry : entries)
     {
-        settingsFile << stringNames[i] << " = " << stringValues[i] << std::endl;
+        settingsFile << entry.name << " = ";
+        if (entry.type == Type::STRING)
+            settingsFile << *static_cast<std::string*>(entry.value);
+        else if (entry.type == Type::INT)
+            settingsFile << *static_cast<int*>(entry.value);
+        else
+            settingsFile << *static_cast<float*>(entry.value);
+        settingsFile << std::endl;
     }
-    for (int i = 0; i < numIntValues; i++)
+    settingsFile.close();
+    return 1;
+}
+// Settings: start reloading the file whenever it's saved
+void lgw::Settings::watch(void)
+{
+    watcher.start();
+}
+// Settings: apply the changes of a reload, if the file changed since the last call
+int lgw::Settings::update(void)
+{
+    if (!watcher.changed())
+        return 0;
+    MemScope memScope(MemTag::SETTINGS);
+    std::vector<int> changed;
+    int count = parse(&changed);
+    if (count <= 0)
+        return 0;
+    reload_derived();
+    for (int i : changed)
     {
-        settingsFile << intNames[i] << " = " << intValues[i] << std::endl;
+        std::cout << "settings: " << entries[i].name << " = " << entries[i].loaded << std::endl;
+        for (Hook& hook : entries[i].hooks)
+            hook(*this);
     }
-    for (int i = 0; i < numFloatValues; i++)
+    return count;
+}
+// Settings: call 'hook' whenever the setting changes through a reload
+void lgw::Settings::onChange(const std::string& name, Hook hook)
+{
+    MemScope memScope(MemTag::SETTINGS);
+    std::unordered_map<std::string, int>::iterator found = index.find(name);
+    if (found == index.end())
     {
-        settingsFile << floatNames[i] << " = " << floatValues[i] << std::endl;
+        std::cout << "settings: no setting named " << name << std::endl;
+        return;
     }
-    settingsFile.close();
-    return 1;
+    entries[found->second].hooks.push_back(hook);
 }
\ No newline at end of file
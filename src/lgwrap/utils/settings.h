@@ -4,85 +4,96 @@
 #include <fstream>
 #include <sstream>
 #include <string>
+#include <vector>
+#include <unordered_map>
+#include <functional>
+
+#include "watch.h"
 
 namespace lgw {
     // store and manage data in a settings file
+    // (every setting is declared once in a schema with its type, default value and valid range; the file is parsed in a
+    // single pass, bad values are reported and ignored instead of crashing, and with watch() the file is reloaded
+    // whenever it's saved, with the changes applied all at once by update() at a frame boundary)
     class Settings {
+    public:
+        // value types
+        enum class Type { STRING, INT, FLOAT };
+        // function called after a setting changed through a reload
+        typedef std::function<void(Settings&)> Hook;
     private:
         // settings file directory
         const char* dir;
-        // size of variable arrays
-        static const int numStringValues = 4;
-        static const int numIntValues = 3;
-        static const int numFloatValues = 5;
-        // where the loaded variables are stored during program execution
-        std::string stringValues[numStringValues] = { "" };
-        int intValues[numIntValues] = { 0 };
-        float floatValues[numFloatValues] = { 0 };
-        // list of variable names (in cooresponding order)
-        const std::string stringNames[numStringValues] = {
-            "window_title",
-            "shader_dir",
-            "asset_dir",
-            "font_dir"
-        };
-        const std::string intNames[numIntValues] = {
-            "window_aspect_ratio_x",
-            "window_aspect_ratio_y",
-            "window_scale"
-        };
-        const std::string floatNames[numFloatValues] = {
-            "fps_cap",
-            "inv_scale_factor",
-            "physics_error_margin",
-            "camera_position_x",
-            "camera_position_y"
+        // schema entry
+        struct Entry {
+            std::string name;
+            Type type;
+            // where the value is stored (one of the members below)
+            void* value;
+            std::string defaultValue;
+            double min, max;
+            // text of the value the last time it was read from the file (empty if it wasn't in the file)
+            std::string loaded;
+            std::vector<Hook> hooks;
         };
+        std::vector<Entry> entries;
+        std::unordered_map<std::string, int> index;
+        // reloads the file when it changes
+        FileWatcher watcher;
+        // add a setting to the schema and set it to its default value
+        void define(const char* name, std::string& value, const char* defaultValue);
+        void define(const char* name, int& value, int defaultValue, int min, int max);
+        void define(const char* name, float& value, float defaultValue, float min, float max);
+        // parse a value into an entry's member (returns false if the text isn't a valid value)
+        bool assign(Entry& entry, const std::string& text);
+        // read the file and apply every value whose text differs from the last time (returns the number of changed
+        // settings, or -1 if the file couldn't be opened)
+        int parse(std::vector<int>* changed);
     public:
-        /*
-        // strings
-        window_title = stringValues[0]
-        shader_dir = stringValues[1]
-        asset_dir = stringValues[2]
-        font_dir = stringValues[3]
-        // integers
-        window_aspect_ratio_x = intValues[0]
-        window_aspect_ratio_y = intValues[1]
-        window_scale = intValues[2]
-        // floats
-        fps_cap = floatValues[0]
-        inv_scale_factor = intValues[1]
-        physics_error_margin = floatValues[2]
-        camera_position_x = floatValues[3]
-        camera_position_y = floatValues[4]
-        */
         // straight from the settings file
-        std::string& window_title = stringValues[0];
-        std::string& shader_dir = stringValues[1];
-        std::string& asset_dir = stringValues[2];
-        std::string& font_dir = stringValues[3];
-        int& window_aspect_ratio_x = intValues[0];
-        int& window_aspect_ratio_y = intValues[1];
-        int& window_scale = intValues[2];
-        float& fps_cap = floatValues[0];
-        float& inv_scale_factor = floatValues[1];
-        float& physics_error_margin = floatValues[2];
-        float& camera_position_x = floatValues[3];
-        float& camera_position_y = floatValues[4];
+        std::string window_title;
+        std::string shader_dir;
+        std::string cache_dir;
+        std::string asset_dir;
+        std::string font_dir;
+        std::string level_dir;
+        int window_aspect_ratio_x = 0;
+        int window_aspect_ratio_y = 0;
+        int window_scale = 0;
+        int vsync = 0;
+        float fps_cap = 0;
+        float inv_scale_factor = 0;
+        float physics_error_margin = 0;
+        int physics_max_substeps = 0;
+        float camera_position_x = 0;
+        float camera_position_y = 0;
+        float background_fps_cap = 0;
+        float level_stream_radius = 0;
         // derived from other settings
         int window_width = 0;
         int window_height = 0;
         float window_aspect_ratio_dec = 0;
         float spf_cap = 0;
+        float spf_background_cap = 0;
         float window_virtual_width = 0;
         float window_virtual_height = 0;
         // constructor
         Settings(const char* fileDir);
+        // the schema points into the object, so it can't be copied
+        Settings(const Settings&) = delete;
+        Settings& operator=(const Settings&) = delete;
         // reload derived settings
         void reload_derived(void);
-        // load settings from a specified directory
+        // load settings from a specified directory (settings missing from the file keep their defaults)
         int load(void);
         // save current settings to a specified directory
         bool save(void);
+        // start reloading the file whenever it's saved
+        void watch(void);
+        // apply the changes of a reload, if the file changed since the last call (call at a frame boundary on the main
+        // thread; hooks of the settings that changed run after all values are updated)
+        int update(void);
+        // call 'hook' whenever the setting changes through a reload
+        void onChange(const std::string& name, Hook hook);
     };
 }
\ No newline at end of file
@@ -0,0 +1,105 @@
+#include "streamer.h"
+
+#include <cmath> // for std::floor and std::sqrt
+#include <algorithm> // for std::min and std::max
+
+// level streamer: destructor
+lgw::LevelStreamer::~LevelStreamer(void)
+{
+	// the load jobs write into this object
+	if (jobs)
+		jobs->wait(loading);
+}
+// level streamer: start streaming the chunks listed by a chunked level
+void lgw::LevelStreamer::init(const Level& level, const std::string& levelPath, JobSystem& jobSystem)
+{
+	jobs = &jobSystem;
+	path = levelPath;
+	chunkSize = level.chunkSize();
+	const LevelChunks& chunks = level.chunks();
+	for (uint32_t i = 0; i < chunks.count; i++)
+		chunkFiles.insert(chunkKey(chunks.x[i], chunks.y[i]));
+}
+// level streamer: distance from a point to the closest point of a chunk
+float lgw::LevelStreamer::distance(int x, int y, Point point) const
+{
+	float dx = std::max(std::max(x * chunkSize - point.x, point.x - (x + 1) * chunkSize), 0.0f);
+	float dy = std::max(std::max(y * chunkSize - point.y, point.y - (y + 1) * chunkSize), 0.0f);
+	return std::sqrt(dx * dx + dy * dy);
+}
+// level streamer: load the chunks around a point, evict the ones that left the radius and hand over finished loads
+void lgw::LevelStreamer::update(Point center, float radius)
+{
+	// the chunks handed over by the last update have been added to the game by now
+	handed.clear();
+	evictedChunks.clear();
+	if (chunkSize <= 0.0f)
+		return;
+
+	// collect finished loads
+	{
+		std::lock_guard<std::mutex> lock(resultMutex);
+		for (Result& result : results)
+			ready.push_back(std::move(result));
+		results.clear();
+	}
+
+	// start loading the chunks that came into the radius
+	int x1 = (int)std::floor((center.x - radius) / chunkSize), x2 = (int)std::floor((center.x + radius) / chunkSize);
+	int y1 = (int)std::floor((center.y - radius) / chunkSize), y2 = (int)std::floor((center.y + radius) / chunkSize);
+	for (int y = y1; y <= y2; y++)
+	{
+		for (int x = x1; x <= x2; x++)
+		{
+			long long key = chunkKey(x, y);
+			if (chunkFiles.count(key) == 0 || entries.count(key) != 0 || distance(x, y, center) > radius)
+				continue;
+			unsigned int serial = nextSerial++;
+			entries[key] = { State::LOADING, serial };
+			std::string file = chunkPath(path, x, y);
+			jobs->submit([this, key, serial, x, y, file]() {
+				std::unique_ptr<StreamedChunk> chunk(new StreamedChunk());
+				chunk->x = x;
+				chunk->y = y;
+				// a chunk that fails to load is handed over empty, so it isn't requested again every frame
+				if (!chunk->level.load(file))
+					chunk->level.prefault();
+				std::lock_guard<std::mutex> lock(resultMutex);
+				results.push_back({ key, serial, std::move(chunk) });
+			}, &loading);
+		}
+	}
+
+	// evict the chunks that left the radius (with some slack so a chunk on the edge isn't loaded and evicted over and
+	// over while the camera moves back and forth)
+	for (std::unordered_map<long long, Entry>::iterator entry = entries.begin(); entry != entries.end();)
+	{
+		int x = (int)(entry->first >> 32);
+		int y = (int)(unsigned int)(entry->first & 0xffffffff);
+		if (distance(x, y, center) <= radius + chunkSize * 0.5f)
+		{
+			++entry;
+			continue;
+		}
+		// loads that are still running are cancelled by forgetting their entry
+		if (entry->second.state == State::RESIDENT)
+		{
+			evictedChunks.push_back({ x, y });
+			resident--;
+		}
+		entry = entries.erase(entry);
+	}
+
+	// hand over a few finished loads
+	while (!ready.empty() && (int)handed.size() < lgwcon::STREAM_CHUNKS_PER_FRAME)
+	{
+		Result result = std::move(ready.front());
+		ready.pop_front();
+		std::unordered_map<long long, Entry>::iterator entry = entries.find(result.key);
+		if (entry == entries.end() || entry->second.serial != result.serial)
+			continue;
+		entry->second.state = State::RESIDENT;
+		resident++;
+		handed.push_back(std::move(result.chunk));
+	}
+}
\ No newline at end of file
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "jobs.h"
+#include "level.h"
+
+// constants
+namespace lgwcon {
+	// most chunks handed over to the game per frame (the rest wait for the next frames, so a burst of finished loads
+	// doesn't turn into one long frame of baking)
+	const int STREAM_CHUNKS_PER_FRAME = 4;
+}
+
+namespace lgw {
+	// chunk coordinates
+	struct ChunkCoord {
+		int x, y;
+	};
+	// chunk of a chunked level that finished loading
+	struct StreamedChunk {
+		int x, y;
+		Level level;
+	};
+
+	// streams the chunk files of a chunked level in and out around a point
+	// (chunk files are mapped and read on the job system; finished chunks are handed over by update at a frame
+	// boundary and chunks that leave the radius are evicted, so memory use and load spikes depend on the radius rather
+	// than the size of the world)
+	class LevelStreamer {
+	public:
+		// constructor
+		LevelStreamer(void) {}
+		// destructor (waits for loads that are still running)
+		~LevelStreamer(void);
+		// start streaming the chunks listed by a chunked level (does nothing for a level that isn't chunked; the job
+		// system has to outlive the streamer)
+		void init(const Level& level, const std::string& levelPath, JobSystem& jobs);
+		// load the chunks within 'radius' of 'center', evict the ones that left it and hand over finished loads (the
+		// results are available through loaded and evicted until the next update)
+		void update(Point center, float radius);
+		// chunks handed over by the last update
+		inline const std::vector<std::unique_ptr<StreamedChunk>>& loaded(void) const { return handed; }
+		// chunks evicted by the last update (their contents should be dropped)
+		inline const std::vector<ChunkCoord>& evicted(void) const { return evictedChunks; }
+		// number of chunks handed over and not evicted since, and number of chunks still loading
+		inline int residentCount(void) const { return resident; }
+		inline int pendingCount(void) const { return (int)entries.size() - resident; }
+		// number of chunks in the level
+		inline int chunkCount(void) const { return (int)chunkFiles.size(); }
+	private:
+		enum class State { LOADING, RESIDENT };
+		struct Entry {
+			State state;
+			// incremented for every load so results of cancelled loads can be recognized
+			unsigned int serial;
+		};
+		struct Result {
+			long long key;
+			unsigned int serial;
+			std::unique_ptr<StreamedChunk> chunk;
+		};
+		// path of the level's main file
+		std::string path;
+		// size of a chunk (0 if the level isn't chunked)
+		float chunkSize = 0.0f;
+		// chunks that have a chunk file
+		std::unordered_set<long long> chunkFiles;
+		// chunks that are loading or resident
+		std::unordered_map<long long, Entry> entries;
+		int resident = 0;
+		unsigned int nextSerial = 0;
+		// job system that loads the chunks
+		JobSystem* jobs = nullptr;
+		JobCounter loading;
+		// finished loads written by the jobs
+		std::mutex resultMutex;
+		std::vector<Result> results;
+		// finished loads waiting to be handed over
+		std::deque<Result> ready;
+		// results of the last update
+		std::vector<std::unique_ptr<StreamedChunk>> handed;
+		std::vector<ChunkCoord> evictedChunks;
+		// distance from a point to the closest point of a chunk
+		float distance(int x, int y, Point point) const;
+		static inline long long chunkKey(int x, int y) { return ((long long)x << 32) | (unsigned int)y; }
+	};
+}
\ No newline at end of file
@@ -1 +1,14 @@
-#include "tools.h"
\ No newline at end of file
+#include "tools.h"
+
+#include <chrono> // for the headless clock
+
+// time in seconds
+double lgw::getTime(void)
+{
+#ifdef LGW_HEADLESS
+	static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+#else
+	return glfwGetTime();
+#endif
+}
\ No newline at end of file
@@ -4,15 +4,18 @@
 #include <GLFW/glfw3.h>
 
 namespace lgw {
+	// time in seconds (glfwGetTime; headless builds that don't link GLFW count from the first call instead)
+	double getTime(void);
+
 	// basic stopwatch
 	class Stopwatch {
 	public:
-		inline Stopwatch(double currentTime = glfwGetTime()) : startTime(currentTime) {}
-		inline double get(double currentTime = glfwGetTime())
+		inline Stopwatch(double currentTime = getTime()) : startTime(currentTime) {}
+		inline double get(double currentTime = getTime())
 		{
 			return currentTime - startTime;
 		}
-		inline void reset(double currentTime = glfwGetTime())
+		inline void reset(double currentTime = getTime())
 		{
 			startTime = currentTime;
 		}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <atomic>
+
+namespace lgw {
+	// lock-free triple buffer for handing whole states from one producer thread to one consumer thread
+	// (the producer always has a buffer to write into and the consumer always has the newest complete state to read,
+	// so neither side ever waits for the other; states the consumer didn't get to are simply skipped)
+	template <typename T>
+	class TripleBuffer {
+	public:
+		inline TripleBuffer(void) : middle(1) {}
+		// producer: buffer to fill in (the contents are whatever was in it two publishes ago)
+		inline T& write(void) { return buffers[back]; }
+		// producer: hand the written buffer to the consumer and take the middle one for the next write
+		inline void publish(void)
+		{
+			back = middle.exchange(back | FRESH, std::memory_order_acq_rel) & INDEX;
+		}
+		// consumer: switch to the newest published state; returns false if nothing was published since the last call
+		inline bool update(void)
+		{
+			if (!(middle.load(std::memory_order_relaxed) & FRESH))
+				return false;
+			front = middle.exchange(front, std::memory_order_acq_rel) & INDEX;
+			return true;
+		}
+		// consumer: newest state taken by update
+		inline const T& read(void) const { return buffers[front]; }
+	private:
+		static const unsigned int INDEX = 3;
+		static const unsigned int FRESH = 4;
+		T buffers[3];
+		// owned by the producer
+		unsigned int back = 0;
+		// shared: index of the middle buffer and whether it holds a state the consumer hasn't taken yet
+		std::atomic<unsigned int> middle;
+		// owned by the consumer
+		unsigned int front = 2;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,127 @@
+#include "watch.h"
+
+#include <iostream>
+#include <chrono>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#elif defined(__linux__)
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#include <limits.h> // for NAME_MAX
+#else
+#include <sys/stat.h>
+#endif
+
+namespace {
+	// how often the watcher thread checks whether it should stop (milliseconds)
+	const int WATCH_INTERVAL = 200;
+}
+
+// file watcher: constructor
+lgw::FileWatcher::FileWatcher(const std::string& path) : path(path), running(false), dirty(false)
+{
+	size_t slash = path.find_last_of("/\\");
+	directory = slash == std::string::npos ? "." : path.substr(0, slash);
+	fileName = slash == std::string::npos ? path : path.substr(slash + 1);
+}
+// file watcher: destructor
+lgw::FileWatcher::~FileWatcher(void)
+{
+	stop();
+}
+// file watcher: start watching
+int lgw::FileWatcher::start(void)
+{
+	if (running)
+		return 0;
+	running = true;
+	thread = std::thread(&FileWatcher::run, this);
+	return 0;
+}
+// file watcher: stop watching
+void lgw::FileWatcher::stop(void)
+{
+	running = false;
+	if (thread.joinable())
+		thread.join();
+}
+
+#if defined(_WIN32)
+// file watcher: wait for change notifications on the directory and compare the file's last write time
+void lgw::FileWatcher::run(void)
+{
+	HANDLE notification = FindFirstChangeNotificationA(directory.c_str(), FALSE, FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME);
+	if (notification == INVALID_HANDLE_VALUE)
+	{
+		std::cout << "watch: failed to watch " << directory << std::endl;
+		return;
+	}
+	WIN32_FILE_ATTRIBUTE_DATA attributes;
+	FILETIME lastWrite = { 0, 0 };
+	if (GetFileAttributesExA(path.c_str(), GetFileExInfoStandard, &attributes))
+		lastWrite = attributes.ftLastWriteTime;
+	while (running)
+	{
+		if (WaitForSingleObject(notification, WATCH_INTERVAL) != WAIT_OBJECT_0)
+			continue;
+		// something in the directory changed; only report it if it was this file
+		if (GetFileAttributesExA(path.c_str(), GetFileExInfoStandard, &attributes) && CompareFileTime(&attributes.ftLastWriteTime, &lastWrite) != 0)
+		{
+			lastWrite = attributes.ftLastWriteTime;
+			dirty = true;
+		}
+		if (!FindNextChangeNotification(notification))
+			break;
+	}
+	FindCloseChangeNotification(notification);
+}
+#elif defined(__linux__)
+// file watcher: read inotify events for the directory and pick out the ones for the file
+void lgw::FileWatcher::run(void)
+{
+	int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (fd < 0 || inotify_add_watch(fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) < 0)
+	{
+		std::cout << "watch: failed to watch " << directory << std::endl;
+		if (fd >= 0)
+			close(fd);
+		return;
+	}
+	alignas(inotify_event) char buffer[16 * (sizeof(inotify_event) + NAME_MAX + 1)];
+	while (running)
+	{
+		pollfd descriptor = { fd, POLLIN, 0 };
+		if (poll(&descriptor, 1, WATCH_INTERVAL) <= 0)
+			continue;
+		ssize_t length = read(fd, buffer, sizeof(buffer));
+		for (ssize_t offset = 0; offset < length;)
+		{
+			const inotify_event* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+			if (event->len > 0 && fileName == event->name)
+				dirty = true;
+			offset += sizeof(inotify_event) + event->len;
+		}
+	}
+	close(fd);
+}
+#else
+// file watcher: poll the file's modification time
+void lgw::FileWatcher::run(void)
+{
+	struct stat info;
+	time_t lastWrite = stat(path.c_str(), &info) == 0 ? info.st_mtime : 0;
+	while (running)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(WATCH_INTERVAL));
+		if (stat(path.c_str(), &info) == 0 && info.st_mtime != lastWrite)
+		{
+			lastWrite = info.st_mtime;
+			dirty = true;
+		}
+	}
+}
+#endif
\ No newline at end of file
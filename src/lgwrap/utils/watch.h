@@ -0,0 +1,34 @@
+#pragma once
+
+#include <string>
+#include <thread>
+#include <atomic>
+
+namespace lgw {
+	// watches a single file for changes on a background thread
+	// (inotify on Linux, directory change notifications on Windows and modification time polling elsewhere; the
+	// directory is watched rather than the file so editors that save by replacing the file are noticed too)
+	class FileWatcher {
+	public:
+		// constructor
+		FileWatcher(const std::string& path);
+		// destructor
+		~FileWatcher(void);
+		// start watching (returns 0 on success)
+		int start(void);
+		// stop watching
+		void stop(void);
+		// return true (once) if the file changed since the last call
+		inline bool changed(void) { return dirty.exchange(false); }
+	private:
+		std::string path;
+		// directory and file name parts of the path
+		std::string directory;
+		std::string fileName;
+		std::thread thread;
+		std::atomic<bool> running;
+		std::atomic<bool> dirty;
+		// platform-specific loop that sets 'dirty' until 'running' is cleared
+		void run(void);
+	};
+}
\ No newline at end of file
@@ -3,9 +3,13 @@
 // standard libraries
 #include <iostream> // for debug
 #include <fstream> // for reading/writing files
-#include <sstream> // for changing the window title
 #include <string> // for when const char* won't work
 #include <cmath> // for advanced math functions
+#include <cstring> // for std::memcpy
+#include <chrono> // for timing the startup
+#include <functional> // for std::function
+#include <vector> // for the level's objects
+#include <algorithm> // for std::min
 
 // public (external) libraries
 #include <glad/glad.h> // loader for OpenGL
@@ -19,6 +23,9 @@
 // local headers
 #include "lgwrap/lgwrap.h"
 #include "const.h"
+#include "bench.h"
+#include "sim.h"
+#include "server.h"
 
 // glfw: whenever the window size changed (by OS or user resize) this callback function executes
 void framebufferSizeCallback(GLFWwindow* window, int width, int height);
@@ -39,12 +46,96 @@ int main(int argc, char** argv)
         std::cout << "Settings file not found" << std::endl;
         return -1;
     }
-    else if (error < -1)
+
+    // headless render benchmark instead of the game
+    if (argc > 1 && std::string(argv[1]) == "--bench")
+        return runBenchmark(settings, argc, argv);
+    // convert a level from the text format into a binary level file
+    if (argc > 1 && std::string(argv[1]) == "--convert-level")
     {
-        std::cout << "Setting #" << -error - 2 << " not found in settings file" << std::endl;
-        return -1;
+        if (argc != 4)
+        {
+            std::cout << "usage: --convert-level <text level> <binary level>" << std::endl;
+            return -1;
+        }
+        return lgw::convertLevel(argv[2], argv[3]);
+    }
+    // rasterize the font into the atlas cache, so the game can start without FreeType
+    if (argc > 1 && std::string(argv[1]) == "--bake-font")
+    {
+        lgw::FontLibrary ftLibrary;
+        lgw::Font font(ftLibrary, settings.font_dir.c_str(), 128);
+        return font.bake(settings.cache_dir);
+    }
+    // re-run a recorded session without a window as fast as possible and check it against the recording
+    if (argc > 1 && std::string(argv[1]) == "--replay")
+    {
+        if (argc != 3)
+        {
+            std::cout << "usage: --replay <replay file>" << std::endl;
+            return -1;
+        }
+        return runReplay(settings, argv[2]);
+    }
+    // run input, simulation and game logic without a window
+    if (argc > 1 && std::string(argv[1]) == "--server")
+        return runServer(settings, argc, argv);
+    // record the input of the session into a replay file, and log the physics counters of every step
+    std::string recordPath;
+    std::string physicsLogPath;
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        if (std::string(argv[i]) == "--record")
+            recordPath = argv[i + 1];
+        else if (std::string(argv[i]) == "--physics-log")
+            physicsLogPath = argv[i + 1];
     }
     
+    // startup: file I/O and CPU work (level decoding, shader sources, the font atlas) run on worker threads while the
+    // main thread creates the window and the GL context; the GL objects are created on the main thread as soon as the
+    // job they depend on is done (timed with std::chrono, glfwGetTime only works after glfwInit)
+    std::chrono::steady_clock::time_point startupTime = std::chrono::steady_clock::now();
+    bool firstFrame = true;
+    // worker threads for engine jobs (startup, asset decoding, chunk baking, ...)
+    lgw::JobSystem jobs;
+    jobs.init();
+
+    // level (memory-mapped and used in place; converted from the text file next to it if it hasn't been yet)
+    lgw::Level level;
+    int levelError = 0;
+    lgw::JobCounter levelLoading;
+    jobs.submit([&]() {
+        if (level.load(settings.level_dir) == 0)
+            return;
+        std::string source = settings.level_dir.substr(0, settings.level_dir.find_last_of('.')) + ".txt";
+        levelError = lgw::convertLevel(source, settings.level_dir) || level.load(settings.level_dir);
+    }, &levelLoading);
+
+    // shader sources
+    const char* shaderNames[3] = { "basic", "texture", "chunk" };
+    std::string shaderSources[3][2];
+    lgw::JobCounter shaderReading;
+    for (int i = 0; i < 3; i++)
+    {
+        jobs.submit([&, i]() {
+            shaderSources[i][0] = lgw::readShaderSource(settings.shader_dir + shaderNames[i] + ".vertex.glsl");
+            shaderSources[i][1] = lgw::readShaderSource(settings.shader_dir + shaderNames[i] + ".fragment.glsl");
+        }, &shaderReading);
+    }
+
+    // the glyph atlas comes from the cache, so FreeType is only started if the font isn't cached yet
+    lgw::FontLibrary ftLibrary;
+    lgw::Font activeFont(ftLibrary, settings.font_dir.c_str(), 128);
+    lgw::JobCounter fontLoading;
+    jobs.submit([&]() { activeFont.prepare(settings.cache_dir); }, &fontLoading);
+
+    // the startup jobs write into the objects above, so they have to be done before any early return
+    std::function<void(void)> finishStartup = [&]() {
+        jobs.wait(levelLoading);
+        jobs.wait(shaderReading);
+        jobs.wait(fontLoading);
+    };
+
     // glfw: initialize and configure
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
@@ -54,16 +145,20 @@ int main(int argc, char** argv)
     #ifdef __APPLE__
         glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
     #endif
+    // input events (queued by the callbacks below)
+    lgw::InputQueue input;
     // glfw: window creation
     GLFWwindow* window = glfwCreateWindow(settings.window_width, settings.window_height, settings.window_title.c_str(), NULL, NULL);
     if (window == NULL)
     {
         std::cout << "glfw: failed to create window" << std::endl;
+        finishStartup();
         glfwTerminate();
         return -1;
     }
     glfwSetWindowAspectRatio(window, 16, 9);
     glfwSetFramebufferSizeCallback(window, framebufferSizeCallback);
+    glfwSetWindowUserPointer(window, &input);
     glfwSetKeyCallback(window, key_callback);
     glfwSetCursorPosCallback(window, cursor_position_callback);
     glfwSetMouseButtonCallback(window, mouse_button_callback);
@@ -73,48 +168,42 @@ int main(int argc, char** argv)
     if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
     {
         std::cout << "glad: init failed" << std::endl;
+        finishStartup();
         glfwTerminate();
         return -1;
     }
-    
-    // basic shader program
-    std::string vertexShaderDir = settings.shader_dir + "basic.vertex.glsl";
-    std::string fragmentShaderDir = settings.shader_dir + "basic.fragment.glsl";
-    lgw::VertexShader* vertexShader = new lgw::VertexShader(GL_VERTEX_SHADER, vertexShaderDir.c_str());
-    vertexShader->compile();
-    lgw::FragmentShader* fragmentShader = new lgw::FragmentShader(GL_FRAGMENT_SHADER, fragmentShaderDir.c_str());
-    fragmentShader->compile();
-    lgw::Shader* basicShader = new lgw::Shader(*vertexShader, *fragmentShader);
-    if (basicShader->link())
-        return -1;
-    delete vertexShader;
-    delete fragmentShader;
-    
-    // texture shader program
-    vertexShaderDir = settings.shader_dir + "texture.vertex.glsl";
-    fragmentShaderDir = settings.shader_dir + "texture.fragment.glsl";
-    lgw::VertexShader* vertexShaderr = new lgw::VertexShader(GL_VERTEX_SHADER, vertexShaderDir.c_str());
-    vertexShaderr->compile();
-    lgw::FragmentShader* fragmentShaderr = new lgw::FragmentShader(GL_FRAGMENT_SHADER, fragmentShaderDir.c_str());
-    fragmentShaderr->compile();
-    lgw::Shader* textureShader = new lgw::Shader(*vertexShaderr, *fragmentShaderr);
-    if (textureShader->link())
+    double windowTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - startupTime).count();
+
+    // shader programs (linked programs are cached on disk, so only the first start after a change compiles them)
+    lgw::ShaderCache shaderCache(settings.cache_dir);
+    shaderCache.init((GLADloadproc)glfwGetProcAddress);
+    jobs.wait(shaderReading);
+    lgw::Shader* basicShader = lgw::linkShader(shaderSources[0][0], shaderSources[0][1], &shaderCache);
+    lgw::Shader* textureShader = lgw::linkShader(shaderSources[1][0], shaderSources[1][1], &shaderCache);
+    lgw::Shader* chunkShader = lgw::linkShader(shaderSources[2][0], shaderSources[2][1], &shaderCache);
+    if (basicShader == nullptr || textureShader == nullptr || chunkShader == nullptr)
+    {
+        finishStartup();
+        glfwTerminate();
         return -1;
-    delete vertexShaderr;
-    delete fragmentShaderr;
+    }
+    std::cout << "gl: " << shaderCache.hits() << " shader programs from the cache, " << shaderCache.misses() << " compiled"
+        << (shaderCache.hits() > 0 && shaderCache.misses() == 0 ? " (warm start)" : " (cold start)") << std::endl;
     
     // gl: set up vertex data, buffers, and configure vertex attributes
     unsigned int rectIndices[6] = {
         0, 1, 3,   // first triangle
         1, 2, 3    // second triangle
     };
-    GLuint VAO_basic, VBO_basic, EBO_basic;
+    // ring buffer that all per-frame vertex data is streamed through
+    lgw::StreamBuffer* streamBuffer = new lgw::StreamBuffer();
+    streamBuffer->init();
+
+    GLuint VAO_basic, EBO_basic;
     glGenVertexArrays(1, &VAO_basic);
     glBindVertexArray(VAO_basic);
 
-    glGenBuffers(1, &VBO_basic);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO_basic);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 8, nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, streamBuffer->id);
 
     glGenBuffers(1, &EBO_basic);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO_basic);
@@ -122,24 +211,33 @@ int main(int argc, char** argv)
 
     glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
     glEnableVertexAttribArray(0);
-
-    glBindVertexArray(VAO_basic);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO_basic);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO_basic);
     
-    GLuint VAO_texture, VBO_texture;
+    GLuint VAO_texture;
     glGenVertexArrays(1, &VAO_texture);
     glBindVertexArray(VAO_texture);
-    glGenBuffers(1, &VBO_texture);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO_texture);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 24, NULL, GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, streamBuffer->id);
     glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), 0);
     glEnableVertexAttribArray(0);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-    lgw::FontLibrary ftLibrary;
-    ftLibrary.init();
-    lgw::Font activeFont(ftLibrary, settings.font_dir.c_str(), 128);
-    activeFont.load();
+    // textures are decoded by the job system and uploaded a few at a time at the start of each frame
+    lgw::TextureLoader* textures = new lgw::TextureLoader(settings.asset_dir);
+    textures->init(jobs);
+
+    // upload the glyph atlas
+    jobs.wait(fontLoading);
+    activeFont.create();
+
+    // the level is needed from here on
+    jobs.wait(levelLoading);
+    if (levelError)
+    {
+        glfwTerminate();
+        return -1;
+    }
+    double loadTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - startupTime).count();
+    std::cout << "startup: window after " << windowTime * 1000.0 << " ms, assets after " << loadTime * 1000.0 << " ms" << std::endl;
 
     //FT_F26Dot6 fontPoint = 100;
     //FT_Set_Char_Size(typeFace, 0, fontPoint * 64, settings.window_width, settings.window_height);
@@ -160,105 +258,191 @@ int main(int argc, char** argv)
     // intersect point for CCD
     lgw::Point intersect;
     
-    // player object
-    lgw::Point playerInitPos = { (settings.window_virtual_width / 2.0f) - 0.5f, 0.0f };
-    lgw::Object player(settings.window_aspect_ratio_dec, settings.inv_scale_factor, lgw::Point(playerInitPos.x, playerInitPos.y), lgw::Point(playerInitPos.x + 1.0f, playerInitPos.y + 1.0f));
-    // additional variables
-    float playerColor[4] = { 0.0f, 0.5f, 1.0f, 1.0f };
-    lgw::Vector playerMoved = { 0.0f, 0.0f };
-    float gravity = -9.8f;
-    bool canJump = false;
-
-    // green box
-    lgw::Barrier2D box(settings.window_aspect_ratio_dec, settings.inv_scale_factor, lgw::Point(0.0f, 0.0f), lgw::Point(2.0f, 2.0f));
-    box.setVertices(settings.camera_position_x, settings.camera_position_y);
-    // additional variables
-    float objectColor[4] = { 0.0f, 1.0f, 0.5f, 1.0f };
+    // game simulation (runs on its own thread; the render loop draws the newest snapshot it published)
+    Simulation* sim = new Simulation(settings, level);
+    lgw::ReplayWriter* recorder = nullptr;
+    if (!recordPath.empty())
+    {
+        recorder = new lgw::ReplayWriter();
+        if (recorder->open(recordPath, settings.level_dir, Simulation::inputKeys, sizeof(Simulation::inputKeys) / sizeof(int)) == 0)
+        {
+            sim->record(recorder);
+            std::cout << "replay: recording to " << recordPath << std::endl;
+        }
+    }
+    if (!physicsLogPath.empty() && sim->logPhysics(physicsLogPath) == 0)
+        std::cout << "physics: logging to " << physicsLogPath << std::endl;
+    sim->start();
+    // player object (only used for drawing; its position is copied from the snapshot every frame)
+    lgw::Object player(sim->snapshot().playerP1, sim->snapshot().playerP2);
+
+    // static level geometry (the level's tiles, baked into per-chunk vertex buffers; the render chunks of a chunked
+    // level line up with its streamed chunks, so an evicted chunk can be dropped as a whole)
+    lgw::ChunkRenderer* staticLevel = new lgw::ChunkRenderer(level.chunkSize() > 0.0f ? level.chunkSize() / lgwcon::CHUNK_SIZE : 1.0f);
+    staticLevel->addRects(level.tiles());
+    // the tiles of a chunked level are streamed in and out around the camera
+    lgw::LevelStreamer* streamer = new lgw::LevelStreamer();
+    streamer->init(level, settings.level_dir, jobs);
 
     // barriers
-    lgw::Barrier1D lowerBound(settings.window_aspect_ratio_dec, settings.inv_scale_factor, lgw::Point(0.0f, 0.0f), lgw::Point(settings.window_virtual_width, 0.0f));
-    lgw::Barrier1D upperBound(settings.window_aspect_ratio_dec, settings.inv_scale_factor, lgw::Point(0.0f, settings.window_virtual_height), lgw::Point(settings.window_virtual_width, settings.window_virtual_height));
-    lgw::Barrier1D leftBound(settings.window_aspect_ratio_dec, settings.inv_scale_factor, lgw::Point(0.0f, 0.0f), lgw::Point(0.0f, settings.window_virtual_height));
-    lgw::Barrier1D rightBound(settings.window_aspect_ratio_dec, settings.inv_scale_factor, lgw::Point(settings.window_virtual_width, 0.0f), lgw::Point(settings.window_virtual_width, settings.window_virtual_height));
+    const lgw::LevelRects& levelBarriers = level.barriers();
+    std::vector<lgw::Barrier1D> barriers;
+    barriers.reserve(levelBarriers.count);
+    for (uint32_t i = 0; i < levelBarriers.count; i++)
+        barriers.emplace_back(lgw::Point(levelBarriers.x1[i], levelBarriers.y1[i]), lgw::Point(levelBarriers.x2[i], levelBarriers.y2[i]));
     // additional variables
     float barrierColor[4] = { 0.75f, 0.0f, 0.0f, 1.0f };
 
-    // initial window width and height
-    float init_virtual_width = settings.window_virtual_width;
-    float init_virtual_height = settings.window_virtual_height;
-
-    // fps counter text
-    std::string fpsText = "FPS: 0 / 0";
+    // particle effects (dust when the player lands, and a fountain that can be switched on with 'E'); particles only
+    // bounce off the edges of the world, the level geometry doesn't affect them
+    lgw::ParticleSystem* particles = new lgw::ParticleSystem();
+    particles->init(*streamBuffer);
+    particles->setBounds(lgw::Box(lgw::Point(0.0f, 0.0f), lgw::Point(level.width(), level.height())));
+    lgw::ParticleEmitter dust;
+    dust.lifetime = 0.5f;
+    dust.lifetimeJitter = 0.2f;
+    dust.velocity = lgw::Vector(0.0f, 1.5f);
+    dust.velocityJitter = lgw::Vector(3.0f, 1.0f);
+    float dustStart[4] = { 0.8f, 0.75f, 0.6f, 0.9f }, dustEnd[4] = { 0.5f, 0.45f, 0.4f, 0.0f };
+    std::memcpy(dust.startColor, dustStart, sizeof(dustStart));
+    std::memcpy(dust.endColor, dustEnd, sizeof(dustEnd));
+    dust.collide = true;
+    dust.bounce = 0.3f;
+    lgw::ParticleEmitter fountainSettings;
+    fountainSettings.position = lgw::Point(level.width() / 2.0f, 0.5f);
+    fountainSettings.rate = 40000.0f;
+    fountainSettings.lifetime = 2.5f;
+    fountainSettings.lifetimeJitter = 0.5f;
+    fountainSettings.velocity = lgw::Vector(0.0f, 12.0f);
+    fountainSettings.velocityJitter = lgw::Vector(4.0f, 3.0f);
+    float fountainStart[4] = { 1.0f, 0.8f, 0.2f, 1.0f }, fountainEnd[4] = { 0.8f, 0.1f, 0.0f, 0.0f };
+    std::memcpy(fountainSettings.startColor, fountainStart, sizeof(fountainStart));
+    std::memcpy(fountainSettings.endColor, fountainEnd, sizeof(fountainEnd));
+    fountainSettings.collide = true;
+    fountainSettings.active = false;
+    int fountain = particles->addEmitter(fountainSettings);
+    // the player was standing on something in the last snapshot
+    bool wasGrounded = true;
+    // time since the last particle update
+    lgw::Stopwatch particleStopwatch;
+
+    // dynamic bodies (only used for drawing, like the player; they follow the bodies in the snapshot)
+    std::vector<lgw::Object> bodies;
+
+    // visibility pass: only objects that overlap the camera's view are submitted for rendering
+    lgw::Culler culler;
+    std::vector<int> barrierIDs;
+    for (lgw::Barrier1D& barrier : barriers)
+        barrierIDs.push_back(culler.add(barrier.p1, barrier.p2));
+    std::vector<int> bodyIDs;
+    int playerID = culler.add(player.p1, player.p2);
+
+    // frames counted during the last second
+    int fps = 0;
 
-    // stores the amount of time elapsed since the beginning of the previous frame
-    double timeElapsed;
-    
     // timers
-    // timer that is reset on every frame
-    lgw::Stopwatch frameStopwatch;
     // timer that is used to update the fps counter once every second
     lgw::Stopwatch fpsStopwatch;
     // counter to count the number of frames
     lgw::Counter fpsCounter;
+    // sleeps out the rest of every frame (and throttles the loop while the window is in the background)
+    lgw::FramePacer pacer(settings.spf_cap, settings.spf_background_cap);
+    pacer.setVsync(settings.vsync != 0);
+    // times the zones of every frame (shown in the debug menu, exported with 'P')
+    lgw::Profiler* profiler = new lgw::Profiler();
+    // transient per-frame data (overlay text, query results, ...); everything in it is released at the end of the frame
+    lgw::Arena* frameArena = new lgw::Arena();
+    // heap allocations of every frame (counted in builds with LGW_TRACK_ALLOCS; once the loop is warmed up, a frame
+    // that doesn't load or change anything shouldn't allocate)
+    lgw::FrameAllocations frameAllocations;
+
+    // settings that can be changed while the game is running (the file is reloaded whenever it's saved; camera
+    // settings need no hook since they're read every frame)
+    settings.onChange("fps_cap", [&](lgw::Settings& changed) {
+        pacer.setTarget(changed.spf_cap, changed.spf_background_cap);
+        sim->tune(changed.physics_error_margin, changed.spf_cap, changed.physics_max_substeps);
+    });
+    settings.onChange("background_fps_cap", [&](lgw::Settings& changed) {
+        pacer.setTarget(changed.spf_cap, changed.spf_background_cap);
+    });
+    settings.onChange("physics_error_margin", [&](lgw::Settings& changed) {
+        sim->tune(changed.physics_error_margin, changed.spf_cap, changed.physics_max_substeps);
+    });
+    settings.onChange("physics_max_substeps", [&](lgw::Settings& changed) {
+        sim->tune(changed.physics_error_margin, changed.spf_cap, changed.physics_max_substeps);
+    });
+    settings.onChange("vsync", [&](lgw::Settings& changed) {
+        pacer.setVsync(changed.vsync != 0);
+    });
+    lgw::Settings::Hook resize = [&](lgw::Settings& changed) {
+        glfwSetWindowAspectRatio(window, changed.window_aspect_ratio_x, changed.window_aspect_ratio_y);
+        glfwSetWindowSize(window, changed.window_width, changed.window_height);
+    };
+    settings.onChange("window_scale", resize);
+    settings.onChange("window_aspect_ratio_x", resize);
+    settings.onChange("window_aspect_ratio_y", resize);
+    settings.watch();
     
     // glfw: program loop
     while (!glfwWindowShouldClose(window))
     {
-        // reset frame stopwatch and record the amount of time elapsed since the beginning of the previous frame
-        timeElapsed = frameStopwatch.get();
-        frameStopwatch.reset();
+        profiler->beginFrame();
+        lgw::MemScope renderScope(lgw::MemTag::RENDER);
+
+        // apply changes to the settings file at the frame boundary
+        if (settings.update() > 0)
+            frameAllocations.allow();
 
         // glfw: input
+        profiler->begin("input");
+        const lgw::InputState& keys = input.state();
+        // a key or button press can start work that allocates the first time it runs (the overlay, a trace export, ...)
+        for (const lgw::InputEvent& event : input.events())
+        {
+            if (event.type != lgw::InputEvent::CURSOR && event.action == GLFW_PRESS)
+                frameAllocations.allow();
+        }
         // close the window if the escape key is pressed
-        if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+        if (keys.pressed(GLFW_KEY_ESCAPE))
             glfwSetWindowShouldClose(window, true);
         // toggle wireframe mode when the space key is pressed down
-        if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS)
-        {
-            if (wireframe.con)
-            {
-                wireframe.con = false;
-                wireframe.toggle();
-                if (wireframe.val)
-                    glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-                else
-                    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-            }
-        }
-        else if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_RELEASE)
+        if (keys.pressed(GLFW_KEY_SPACE))
         {
-            wireframe.con = true;
+            wireframe.toggle();
+            if (wireframe.val)
+                glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+            else
+                glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
         }
         // toggle fps
-        if (glfwGetKey(window, GLFW_KEY_GRAVE_ACCENT) == GLFW_PRESS)
+        if (keys.pressed(GLFW_KEY_GRAVE_ACCENT))
+            showFPS.toggle();
+        // toggle the particle fountain
+        if (keys.pressed(GLFW_KEY_E))
+            particles->emitter(fountain).active = !particles->emitter(fountain).active;
+        // write the profiler history to a trace file
+        if (keys.pressed(GLFW_KEY_P))
         {
-            if (showFPS.con)
-            {
-                showFPS.con = false;
-                showFPS.toggle();
-            }
-        }
-        else if (glfwGetKey(window, GLFW_KEY_GRAVE_ACCENT) == GLFW_RELEASE)
-        {
-            showFPS.con = true;
+            if (!profiler->exportTrace(CONST::TRACE_DIR))
+                std::cout << "profiler: trace written to " << CONST::TRACE_DIR << std::endl;
         }
 
         // zooming in and out
-        if (glfwGetKey(window, GLFW_KEY_F) == GLFW_PRESS)
+        if (keys.held(GLFW_KEY_F))
             settings.inv_scale_factor -= 0.1f;
-        else if (glfwGetKey(window, GLFW_KEY_G) == GLFW_PRESS)
+        else if (keys.held(GLFW_KEY_G))
             settings.inv_scale_factor += 0.1f;
         // moving the camera
-        if (glfwGetKey(window, GLFW_KEY_I) == GLFW_PRESS)
+        if (keys.held(GLFW_KEY_I))
             settings.camera_position_y += 0.01f;
-        else if (glfwGetKey(window, GLFW_KEY_K) == GLFW_PRESS)
+        else if (keys.held(GLFW_KEY_K))
             settings.camera_position_y -= 0.01f;
-        if (glfwGetKey(window, GLFW_KEY_L) == GLFW_PRESS)
+        if (keys.held(GLFW_KEY_L))
             settings.camera_position_x += 0.01f;
-        else if (glfwGetKey(window, GLFW_KEY_J) == GLFW_PRESS)
+        else if (keys.held(GLFW_KEY_J))
             settings.camera_position_x -= 0.01f;
         // reset camera position and zoom
-        if (glfwGetKey(window, GLFW_KEY_Y) == GLFW_PRESS)
+        if (keys.held(GLFW_KEY_Y))
         {
             settings.camera_position_x = 0.0f;
             settings.camera_position_y = 0.0f;
@@ -266,136 +450,307 @@ int main(int argc, char** argv)
         }
 
         settings.reload_derived();
-
-        // move the player to a set location when the 'T' key is pressed
-        if (glfwGetKey(window, GLFW_KEY_T) == GLFW_PRESS)
+        profiler->end();
+
+        // take the newest state published by the simulation
+        sim->poll();
+        const SimSnapshot& state = sim->snapshot();
+        player.p1 = state.playerP1;
+        player.p2 = state.playerP2;
+        // the simulation spawns and despawns bodies, so the number of drawables follows the snapshot
+        if (bodies.size() != state.bodies.size())
+            frameAllocations.allow();
+        while (bodies.size() < state.bodies.size())
         {
-            player.velocity.x = 0.0f;
-            player.velocity.y = 0.0f;
-            player.p1 = playerInitPos;
-            player.p2 = playerInitPos + 1.0f;
+            const lgw::Box& body = state.bodies[bodies.size()];
+            bodies.emplace_back(body.p1, body.p2);
+            bodyIDs.push_back(culler.add(body.p1, body.p2));
         }
-
-        // player movement
-        if (canJump && glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
-            playerMoved.y = 7.0f / (float)timeElapsed;
-        else if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
-            playerMoved.y = -0.2f / (float)timeElapsed;
-        if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
-            playerMoved.x = 0.2f / (float)timeElapsed;
-        else if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
-            playerMoved.x = -0.2f / (float)timeElapsed;
-        
-        // move the player
-        player.calcTimeStep((float)timeElapsed, playerMoved.x, playerMoved.y + gravity);
-        playerMoved.x = 0.0f;
-        playerMoved.y = 0.0f;
-
-        lgw::Point playerLeft(player.p1.x, player.p2.y);
-        lgw::Point playerRight(player.p2.x, player.p1.y);
-        // detect and resolve collisions
-        voidMinorPosDiff(player.p1, playerLeft, settings.physics_error_margin);
-
-        if (player.p1.x < 0.0f)
+        while (bodies.size() > state.bodies.size())
         {
-            player.p1.x = 0.0f;
-            player.p2.x = 1.0f;
-            player.velocity.x = 0.0f;
+            bodies.pop_back();
+            culler.remove(bodyIDs.back());
+            bodyIDs.pop_back();
         }
-        else if (player.p2.x > init_virtual_width)
+        for (size_t i = 0; i < bodies.size(); i++)
         {
-            player.p1.x = init_virtual_width - 1.0f;
-            player.p2.x = init_virtual_width;
-            player.velocity.x = 0.0f;
+            bodies[i].p1 = state.bodies[i].p1;
+            bodies[i].p2 = state.bodies[i].p2;
         }
 
-        if (player.p1.y < 0.0f)
-        {
-            canJump = true;
-            player.p1.y = 0.0f;
-            player.p2.y = 1.0f;
-            player.velocity.y = 0.0f;
-        }
-        else
+        // kick up dust when the player lands, then move the particles (a long stall isn't simulated in one go)
+        profiler->begin("particles");
+        if (state.canJump && !wasGrounded)
         {
-            canJump = false;
-            if (player.p2.y > init_virtual_height)
-            {
-                player.p1.y = init_virtual_height - 1.0f;
-                player.p2.y = init_virtual_height;
-                player.velocity.y = 0.0f;
-            }
+            dust.position = lgw::Point((state.playerP1.x + state.playerP2.x) / 2.0f, std::fmin(state.playerP1.y, state.playerP2.y));
+            particles->burst(dust, 200);
         }
+        wasGrounded = state.canJump;
+        particles->update((float)std::fmin(particleStopwatch.get(), 0.1));
+        particleStopwatch.reset();
+        profiler->end();
+
+        // upload textures that finished decoding since the last frame
+        if (textures->pending() > 0)
+            frameAllocations.allow();
+        textures->update();
+
+        // find the objects that are visible through the camera
+        lgw::Box view = lgw::viewBox(settings.window_aspect_ratio_dec, settings.inv_scale_factor, settings.camera_position_x, settings.camera_position_y);
+        culler.move(playerID, player.p1, player.p2);
+        for (size_t i = 0; i < bodies.size(); i++)
+            culler.move(bodyIDs[i], bodies[i].p1, bodies[i].p2);
+        culler.update(view);
+
+        // stream level chunks in and out around the center of the view
+        streamer->update(lgw::Point((view.p1.x + view.p2.x) / 2.0f, (view.p1.y + view.p2.y) / 2.0f), settings.level_stream_radius);
+        for (const std::unique_ptr<lgw::StreamedChunk>& chunk : streamer->loaded())
+            staticLevel->addRects(chunk->level.tiles());
+        for (const lgw::ChunkCoord& chunk : streamer->evicted())
+            staticLevel->removeChunk(chunk.x, chunk.y);
+        if (streamer->pendingCount() > 0 || !streamer->loaded().empty() || !streamer->evicted().empty())
+            frameAllocations.allow();
 
         // gl: clear window
         glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
         glClear(GL_COLOR_BUFFER_BIT);
 
         // render text
+        profiler->begin("text render", true);
         if (showFPS.val)
         {
-            activeFont.startRender(VAO_texture, VBO_texture, textureShader, settings.window_width, settings.window_height);
-            activeFont.render(textureShader, fpsText.c_str(), 5.0f, 870.0f, 1.0f, glm::vec3(0.0, 0.8f, 0.8f));
+            lgw::MemScope textScope(lgw::MemTag::TEXT);
+            activeFont.startRender(VAO_texture, *streamBuffer, textureShader, settings.window_width, settings.window_height);
+            // the overlay text is built in the frame arena, so drawing it doesn't allocate
+            lgw::TextBuilder fpsText(*frameArena);
+            fpsText << "FPS: " << fps << " / " << (int)settings.fps_cap;
+            fpsText.fixed(3) << "   Physics: " << state.physics.totalTime() * 1000.0 << " ms/step";
+            activeFont.render(textureShader, fpsText.view(), 5.0f, 870.0f, 1.0f, glm::vec3(0.0, 0.8f, 0.8f));
+            lgw::TextBuilder visibleText(*frameArena);
+            visibleText << "Visible: " << culler.visibleCount() << " / " << culler.totalCount()
+                << "   Chunks: " << staticLevel->drawnCount() << " / " << staticLevel->chunkCount()
+                << "   Streamed: " << streamer->residentCount() << " / " << streamer->chunkCount()
+                << " (" << streamer->pendingCount() << " loading)";
+            activeFont.render(textureShader, visibleText.view(), 5.0f, 660.0f, 1.0f, glm::vec3(0.0, 0.8f, 0.8f));
+            lgw::TextBuilder textureText(*frameArena);
+            textureText << "Textures: " << textures->count() - textures->pending() << " / " << textures->count();
+            activeFont.render(textureShader, textureText.view(), 5.0f, 630.0f, 1.0f, glm::vec3(0.0, 0.8f, 0.8f));
+            lgw::TextBuilder pacingText(*frameArena);
+            pacingText.fixed(2) << "Pacing: " << pacer.averageError() * 1000.0 << " ms avg   "
+                << pacer.maxError() * 1000.0 << " ms max   " << pacer.missedFrames() << " missed" << (pacer.vsync() ? "   vsync" : "");
+            activeFont.render(textureShader, pacingText.view(), 5.0f, 600.0f, 1.0f, glm::vec3(0.0, 0.8f, 0.8f));
+            lgw::TextBuilder frameText(*frameArena);
+            frameText.fixed(2) << "Frame: " << profiler->percentile(50.0, frameArena) * 1000.0 << " ms p50   "
+                << profiler->percentile(95.0, frameArena) * 1000.0 << " ms p95   " << profiler->percentile(99.0, frameArena) * 1000.0
+                << " ms p99   (P: export trace)";
+            activeFont.render(textureShader, frameText.view(), 5.0f, 570.0f, 1.0f, glm::vec3(0.0, 0.8f, 0.8f));
+            const char* zones[4] = { "input", "text render", "geometry render", "swap" };
+            for (int i = 0; i < 4; i++)
+            {
+                double cpu, gpu;
+                profiler->average(zones[i], cpu, gpu);
+                lgw::TextBuilder zoneText(*frameArena);
+                zoneText.fixed(2) << "  " << zones[i] << ": " << cpu * 1000.0 << " ms cpu";
+                if (gpu >= 0.0)
+                    zoneText << "   " << gpu * 1000.0 << " ms gpu";
+                activeFont.render(textureShader, zoneText.view(), 5.0f, 540.0f - 30.0f * i, 1.0f, glm::vec3(0.0, 0.8f, 0.8f));
+            }
+            lgw::TextBuilder simText(*frameArena);
+            simText.fixed(2) << "  Sim: " << state.rate << " steps/s   " << state.stepTime * 1000.0 << " ms/step   input latency "
+                << state.inputLatency * 1000.0 << " ms   " << state.substeps << " substeps   " << state.contacts << " contacts   step " << state.step;
+            activeFont.render(textureShader, simText.view(), 5.0f, 420.0f, 1.0f, glm::vec3(0.0, 0.8f, 0.8f));
+            lgw::TextBuilder jobText(*frameArena);
+            jobText << "Jobs: " << jobs.workerCount() << " workers   " << jobs.executed() << " run   " << jobs.stolen() << " stolen";
+            activeFont.render(textureShader, jobText.view(), 5.0f, 390.0f, 1.0f, glm::vec3(0.0, 0.8f, 0.8f));
+            lgw::TextBuilder arenaText(*frameArena);
+            arenaText.fixed(1) << "Frame arena: " << frameArena->lastUsed() / 1024.0 << " KB last frame   " << frameArena->peak() / 1024.0
+                << " KB peak   " << frameArena->capacity() / 1024.0 << " KB capacity   " << frameArena->overflows() << " overflows";
+            activeFont.render(textureShader, arenaText.view(), 5.0f, 360.0f, 1.0f, glm::vec3(0.0, 0.8f, 0.8f));
+            double particleCPU, particleGPU;
+            profiler->average("particles", particleCPU, particleGPU);
+            lgw::TextBuilder particleText(*frameArena);
+            particleText.fixed(2) << "Particles: " << particles->count() << "   " << particleCPU * 1000.0 << " ms update";
+            activeFont.render(textureShader, particleText.view(), 5.0f, 330.0f, 1.0f, glm::vec3(0.0, 0.8f, 0.8f));
+            const lgw::PhysicsCounters& physics = state.physics;
+            lgw::TextBuilder physicsText(*frameArena);
+            physicsText << "Physics: " << physics.bodiesIntegrated << " bodies   " << physics.broadphasePairs << " pairs   "
+                << physics.narrowphaseTests << " tests   " << physics.hits << " hits   " << physics.contactsResolved << " contacts   "
+                << physics.sleepingBodies << " sleeping";
+            activeFont.render(textureShader, physicsText.view(), 5.0f, 300.0f, 1.0f, glm::vec3(0.0, 0.8f, 0.8f));
+            lgw::TextBuilder phaseText(*frameArena);
+            phaseText.fixed(3) << "  integrate " << physics.integrateTime * 1000.0 << " ms   collide " << physics.collideTime * 1000.0
+                << " ms   contacts " << physics.contactTime * 1000.0 << " ms";
+            activeFont.render(textureShader, phaseText.view(), 5.0f, 270.0f, 1.0f, glm::vec3(0.0, 0.8f, 0.8f));
+            lgw::TextBuilder allocText(*frameArena);
+            lgw::TextBuilder tagText(*frameArena);
+            if (lgw::memtrack::enabled())
+            {
+                lgw::MemCounters heap = lgw::memtrack::counters(lgw::MemTag::COUNT);
+                allocText.fixed(1) << "Allocations: " << frameAllocations.allocations() << " last frame (" << frameAllocations.bytes() << " B)   "
+                    << frameAllocations.peakAllocations() << " peak (" << frameAllocations.peakBytes() << " B)   heap " << heap.liveBytes / 1024.0
+                    << " KB   peak " << heap.peakBytes / 1024.0 << " KB   " << frameAllocations.steadyAllocatingFrames() << " steady frames allocated";
+                tagText << " ";
+                for (int i = 0; i < (int)lgw::MemTag::COUNT; i++)
+                    tagText << " " << lgw::memTagName((lgw::MemTag)i) << ": " << frameAllocations.allocations((lgw::MemTag)i) << " (" << frameAllocations.bytes((lgw::MemTag)i) << " B)";
+            }
+            else
+            {
+                allocText << "Allocations: not tracked (build with LGW_TRACK_ALLOCS)";
+            }
+            activeFont.render(textureShader, allocText.view(), 5.0f, 240.0f, 1.0f, glm::vec3(0.0, 0.8f, 0.8f));
+            activeFont.render(textureShader, tagText.view(), 5.0f, 210.0f, 1.0f, glm::vec3(0.0, 0.8f, 0.8f));
             activeFont.render(textureShader, "Move player : W A S D", 5.0f, 840.0f, 1.0f, glm::vec3(0.8, 0.8f, 0.8f));
             activeFont.render(textureShader, "Respawn : T", 5.0f, 810.0f, 1.0f, glm::vec3(0.8, 0.8f, 0.8f));
             activeFont.render(textureShader, "Move scene : I J K L", 5.0f, 780.0f, 1.0f, glm::vec3(0.8, 0.8f, 0.8f));
             activeFont.render(textureShader, "Change scene scale : F G", 5.0f, 750.0f, 1.0f, glm::vec3(0.8, 0.8f, 0.8f));
             activeFont.render(textureShader, "Reset scene : Y", 5.0f, 720.0f, 1.0f, glm::vec3(0.8, 0.8f, 0.8f));
-            activeFont.render(textureShader, "Toggle wireframe mode : SPACE", 5.0f, 690.0f, 1.0f, glm::vec3(0.8, 0.8f, 0.8f));
+            activeFont.render(textureShader, "Toggle wireframe mode : SPACE   Particle fountain : E", 5.0f, 690.0f, 1.0f, glm::vec3(0.8, 0.8f, 0.8f));
             activeFont.stopRender();
         }
+        profiler->end();
         
-        // gl: bind basic VAO, VBO, and EBO
+        // gl: rebake static chunks that changed and draw the ones in view
+        profiler->begin("geometry render", true);
+        profiler->begin("static level");
+        staticLevel->bake(&jobs);
+        staticLevel->render(chunkShader, view, settings.window_aspect_ratio_dec, settings.inv_scale_factor, settings.camera_position_x, settings.camera_position_y);
+
+        profiler->end();
+
+        // gl: write the vertices of the visible objects into the stream buffer, one map per batch of objects (a level
+        // can have more objects than the buffer holds; a batch that can't be mapped is skipped)
+        profiler->begin("objects");
+        GLintptr streamOffset;
+
+        // gl: bind basic VAO
         glBindVertexArray(VAO_basic);
-        glBindBuffer(GL_ARRAY_BUFFER, VBO_basic);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO_basic);
         basicShader->use();
-        
-        // gl: render barriers
-        lowerBound.setVertices(settings.camera_position_x, settings.camera_position_y);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(lowerBound.vertices), lowerBound.vertices);
+
+        // gl: render barriers (the visible lines of a batch with one draw)
         glUniform4f(basicShader->uniLoc("color"), barrierColor[0], barrierColor[1], barrierColor[2], barrierColor[3]);
-        glDrawArrays(GL_LINES, 0, 2);
+        for (size_t first = 0; first < barriers.size(); first += CONST::OBJECT_BATCH)
+        {
+            size_t last = std::min(barriers.size(), first + CONST::OBJECT_BATCH);
+            float* lines = (float*)streamBuffer->map(sizeof(float) * 4 * (last - first), sizeof(float) * 2, streamOffset);
+            if (lines == nullptr)
+                continue;
+            int boundCount = 0;
+            for (size_t i = first; i < last; i++)
+            {
+                if (culler.visible(barrierIDs[i]))
+                {
+                    barriers[i].setVertices(settings.window_aspect_ratio_dec, settings.inv_scale_factor, settings.camera_position_x, settings.camera_position_y);
+                    std::memcpy(lines + boundCount * 4, barriers[i].vertices, sizeof(barriers[i].vertices));
+                    boundCount++;
+                }
+            }
+            streamBuffer->unmap();
+            if (boundCount > 0)
+                glDrawArrays(GL_LINES, (GLint)(streamOffset / (sizeof(float) * 2)), boundCount * 2);
+        }
+
+        // gl: render the player
+        if (culler.visible(playerID))
+        {
+            float* quad = (float*)streamBuffer->map(sizeof(player.vertices), sizeof(float) * 2, streamOffset);
+            if (quad != nullptr)
+            {
+                player.setVertices(settings.window_aspect_ratio_dec, settings.inv_scale_factor, settings.camera_position_x, settings.camera_position_y);
+                std::memcpy(quad, player.vertices, sizeof(player.vertices));
+                streamBuffer->unmap();
+                glUniform4f(basicShader->uniLoc("color"), state.playerColor[0], state.playerColor[1], state.playerColor[2], state.playerColor[3]);
+                glDrawElementsBaseVertex(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, (GLint)(streamOffset / (sizeof(float) * 2)));
+            }
+        }
+
+        // gl: render the dynamic bodies (the visible quads of a batch are written first, then drawn in the same order)
+        for (size_t first = 0; first < bodies.size(); first += CONST::OBJECT_BATCH)
+        {
+            size_t last = std::min(bodies.size(), first + CONST::OBJECT_BATCH);
+            float* quads = (float*)streamBuffer->map(sizeof(float) * 8 * (last - first), sizeof(float) * 2, streamOffset);
+            if (quads == nullptr)
+                continue;
+            int quadCount = 0;
+            for (size_t i = first; i < last; i++)
+            {
+                if (culler.visible(bodyIDs[i]))
+                {
+                    bodies[i].setVertices(settings.window_aspect_ratio_dec, settings.inv_scale_factor, settings.camera_position_x, settings.camera_position_y);
+                    std::memcpy(quads + quadCount * 8, bodies[i].vertices, sizeof(bodies[i].vertices));
+                    quadCount++;
+                }
+            }
+            streamBuffer->unmap();
+            GLint firstVertex = (GLint)(streamOffset / (sizeof(float) * 2));
+            quadCount = 0;
+            for (size_t i = first; i < last; i++)
+            {
+                if (!culler.visible(bodyIDs[i]))
+                    continue;
+                const float* bodyColor = state.bodyColors[i].rgba;
+                glUniform4f(basicShader->uniLoc("color"), bodyColor[0], bodyColor[1], bodyColor[2], bodyColor[3]);
+                glDrawElementsBaseVertex(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, firstVertex + quadCount * 4);
+                quadCount++;
+            }
+        }
+        profiler->end();
 
-        upperBound.setVertices(settings.camera_position_x, settings.camera_position_y);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(upperBound.vertices), upperBound.vertices);
-        glDrawArrays(GL_LINES, 0, 2);
+        // gl: render every particle with one draw
+        profiler->begin("particle render");
+        particles->render(*streamBuffer, chunkShader, settings.window_aspect_ratio_dec, settings.inv_scale_factor, settings.camera_position_x, settings.camera_position_y,
+            std::fmax(2.0f, 20.0f / settings.inv_scale_factor));
+        glBindVertexArray(VAO_basic);
+        basicShader->use();
+        profiler->end();
 
-        leftBound.setVertices(settings.camera_position_x, settings.camera_position_y);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(leftBound.vertices), leftBound.vertices);
-        glDrawArrays(GL_LINES, 0, 2);
+        // gl: frame time graph in the bottom right corner (the flat line is the frame time target)
+        if (showFPS.val)
+        {
+            double fullScale = settings.spf_cap > 0.0f ? 2.0 * settings.spf_cap : 1.0 / 30.0;
+            float* graph = (float*)streamBuffer->map(sizeof(float) * 2 * (lgwcon::PROFILER_HISTORY + 1), sizeof(float) * 2, streamOffset);
+            if (graph != nullptr)
+            {
+                float targetY = -0.95f + 0.4f * (float)(settings.spf_cap / fullScale);
+                graph[0] = 0.35f; graph[1] = targetY;
+                graph[2] = 0.95f; graph[3] = targetY;
+                int points = profiler->graph(graph + 4, lgwcon::PROFILER_HISTORY - 1, 0.35f, -0.95f, 0.6f, 0.4f, fullScale);
+                streamBuffer->unmap();
+                GLint graphFirst = (GLint)(streamOffset / (sizeof(float) * 2));
+                glUniform4f(basicShader->uniLoc("color"), 0.4f, 0.4f, 0.4f, 1.0f);
+                glDrawArrays(GL_LINES, graphFirst, 2);
+                glUniform4f(basicShader->uniLoc("color"), 0.0f, 0.8f, 0.8f, 1.0f);
+                glDrawArrays(GL_LINE_STRIP, graphFirst + 2, points);
+            }
+        }
 
-        rightBound.setVertices(settings.camera_position_x, settings.camera_position_y);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(rightBound.vertices), rightBound.vertices);
-        glDrawArrays(GL_LINES, 0, 2);
-        
-        // gl: render the player
-        player.setVertices(settings.camera_position_x, settings.camera_position_y);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(player.vertices), player.vertices);
-        glUniform4f(basicShader->uniLoc("color"), playerColor[0], playerColor[1], playerColor[2], playerColor[3]);
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-            
-        // gl: render the green box
-        box.setVertices(settings.camera_position_x, settings.camera_position_y); // box position is static; no need to update vertices on every frame
-        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(box.vertices), box.vertices);
-        glUniform4f(basicShader->uniLoc("color"), objectColor[0], objectColor[1], objectColor[2], objectColor[3]);
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-
-        // gl: unbind VAO, VBO, and EBO
+        // gl: unbind VAO and fence this frame's part of the stream buffer
         glBindVertexArray(0);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        streamBuffer->endFrame();
+        profiler->end();
         
         // glfw: swap buffers and poll IO events
+        profiler->begin("swap");
         glfwSwapBuffers(window);
         glfwPollEvents();
+        profiler->end();
+        if (firstFrame)
+        {
+            std::cout << "startup: first frame after " << std::chrono::duration<double>(std::chrono::steady_clock::now() - startupTime).count() * 1000.0
+                << " ms" << std::endl;
+            firstFrame = false;
+        }
+
+        // apply the events of this frame to the input state and hand them to the simulation right away
+        input.update();
+        sim->pushInput(input.events());
+        // the events of this frame were queued while polling, so a burst bigger than the queues allocated
+        if (input.overflowed())
+            frameAllocations.allow();
         
         // update fps counter every second
         if (fpsStopwatch.get() >= 1.0)
         {
-            std::stringstream frameCount;
-            frameCount << "FPS: " << fpsCounter.get() << " / " << settings.fps_cap;
-            fpsText = frameCount.str();
+            fps = fpsCounter.get();
             fpsCounter.set(0);
             fpsStopwatch.reset();
         }
@@ -404,21 +759,34 @@ int main(int argc, char** argv)
             fpsCounter.inc();
         }
 
+        // everything allocated from the frame arena during this frame is released
+        frameArena->reset();
+        frameAllocations.frame();
+
         // wait until the next frame
-        while (frameStopwatch.get() < settings.spf_cap)
-        {
-            // do nothing
-        }
+        profiler->begin("wait");
+        pacer.wait(window);
+        profiler->end();
     }
     
+    // stop the simulation thread
+    delete sim;
+    delete recorder;
+    delete streamer;
+
     // gl: de-allocate all resources once they've outlived their purpose:
     glDeleteVertexArrays(1, &VAO_basic);
-    glDeleteBuffers(1, &VBO_basic);
     glDeleteBuffers(1, &EBO_basic);
     glDeleteVertexArrays(1, &VAO_texture);
-    glDeleteBuffers(1, &VBO_texture);
+    delete particles;
+    delete streamBuffer;
     delete basicShader;
     delete textureShader;
+    delete chunkShader;
+    delete staticLevel;
+    delete textures;
+    delete profiler;
+    delete frameArena;
     
     // glfw: terminate, clearing all previously allocated GLFW resources.
     glfwTerminate();
@@ -436,35 +804,17 @@ void framebufferSizeCallback(GLFWwindow* window, int width, int height)
 // glfw: whenever a key is pressed this callback function executes
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
 {
-    switch (key)
-    {
-    case GLFW_KEY_W: {
-        break;
-    }
-    case GLFW_KEY_A: {
-        break;
-    }
-    case GLFW_KEY_S: {
-        break;
-    }
-    case GLFW_KEY_D: {
-        break;
-    }
-    default: {
-        // do nothing
-        return;
-    }
-    }
+    static_cast<lgw::InputQueue*>(glfwGetWindowUserPointer(window))->push(lgw::InputEvent::KEY, key, action, mods);
 }
 
 // glfw: whenever the mouse is moved this callback function executes
 void cursor_position_callback(GLFWwindow* window, double xpos, double ypos)
 {
-
+    static_cast<lgw::InputQueue*>(glfwGetWindowUserPointer(window))->push(lgw::InputEvent::CURSOR, 0, 0, 0, xpos, ypos);
 }
 
 // glfw: whenever the mouse is clicked this callback function executes
 void mouse_button_callback(GLFWwindow* window, int button, int action, int mods)
 {
-
+    static_cast<lgw::InputQueue*>(glfwGetWindowUserPointer(window))->push(lgw::InputEvent::MOUSE_BUTTON, button, action, mods);
 }
\ No newline at end of file
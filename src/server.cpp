@@ -0,0 +1,238 @@
+// standard libraries
+#include <iostream> // for the report
+#include <string> // for when const char* won't work
+#include <vector>
+#include <algorithm> // for std::max
+#include <cstdlib> // for std::atof and std::atoll
+#include <csignal> // for stopping on Ctrl+C
+
+// public (external) libraries
+#ifndef LGW_HEADLESS
+#include <glad/glad.h> // loader for OpenGL (has to come before GLFW)
+#endif
+#include <GLFW/glfw3.h> // for the key actions
+
+// local headers
+#include "server.h"
+#include "sim.h"
+#ifdef LGW_HEADLESS
+#include "const.h"
+#endif
+
+namespace {
+    // server options
+    struct ServerOptions {
+        std::string level;
+        double rate = 0.0;
+        bool fast = false;
+        long long steps = 0;
+        std::string input;
+        std::string record;
+        std::string physicsLog;
+        double report = 10.0;
+    };
+
+    // set by Ctrl+C (or by the service manager stopping the process)
+    volatile std::sig_atomic_t stopRequested = 0;
+    void requestStop(int)
+    {
+        stopRequested = 1;
+    }
+
+    // parse the command line (returns false on unknown options)
+    bool parseOptions(int argc, char** argv, ServerOptions& options)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            std::string arg = argv[i];
+            bool hasValue = (i + 1 < argc);
+            if (arg == "--server")
+                continue;
+            else if (arg == "--fast")
+                options.fast = true;
+            else if (arg == "--level" && hasValue)
+                options.level = argv[++i];
+            else if (arg == "--rate" && hasValue)
+                options.rate = std::atof(argv[++i]);
+            else if (arg == "--steps" && hasValue)
+                options.steps = std::atoll(argv[++i]);
+            else if (arg == "--input" && hasValue)
+                options.input = argv[++i];
+            else if (arg == "--record" && hasValue)
+                options.record = argv[++i];
+            else if (arg == "--physics-log" && hasValue)
+                options.physicsLog = argv[++i];
+            else if (arg == "--report" && hasValue)
+                options.report = std::atof(argv[++i]);
+            else
+            {
+                std::cout << "server: unknown option " << arg << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // load a binary level (converted from the text file next to it if it hasn't been yet)
+    int loadLevel(const std::string& path, lgw::Level& level)
+    {
+        if (level.load(path) == 0)
+            return 0;
+        std::string source = path.substr(0, path.find_last_of('.')) + ".txt";
+        return lgw::convertLevel(source, path) || level.load(path);
+    }
+
+    // turn the keys of the next step of a replay into input events (every key is released once the replay ends)
+    void replayInput(lgw::ReplayReader& input, uint32_t& held, std::vector<lgw::InputEvent>& events)
+    {
+        lgw::ReplayRecord record;
+        uint32_t keys = 0;
+        while (input.next(record))
+        {
+            if (record.type == lgw::ReplayRecord::STEP)
+            {
+                keys = record.keys;
+                break;
+            }
+        }
+        events.clear();
+        for (size_t i = 0; i < input.keys().size(); i++)
+        {
+            uint32_t bit = 1u << i;
+            if ((keys & bit) == (held & bit))
+                continue;
+            events.push_back({ lgw::InputEvent::KEY, input.keys()[i], (keys & bit) != 0 ? GLFW_PRESS : GLFW_RELEASE, 0, 0.0, 0.0, lgw::getTime() });
+        }
+        held = keys;
+    }
+}
+
+// headless server
+int runServer(lgw::Settings& settings, int argc, char** argv)
+{
+    ServerOptions options;
+    if (!parseOptions(argc, argv, options))
+        return -1;
+    if (options.level.empty())
+        options.level = settings.level_dir;
+    // every step advances the simulation by the same time
+    double stepTime = options.rate > 0.0 ? 1.0 / options.rate : (settings.spf_cap > 0.0f ? settings.spf_cap : 1.0 / 60.0);
+
+    // the level is loaded on this thread (a server has nothing else to do in the meantime, and without a job system an
+    // instance needs only the one thread)
+    lgw::Level level;
+    if (loadLevel(options.level, level))
+    {
+        std::cout << "server: failed to load the level " << options.level << std::endl;
+        return -1;
+    }
+    Simulation sim(settings, level);
+
+    // replays to record into and to take the input from
+    lgw::ReplayWriter recorder;
+    if (!options.record.empty())
+    {
+        if (recorder.open(options.record, options.level, Simulation::inputKeys, sizeof(Simulation::inputKeys) / sizeof(int)))
+            return -1;
+        sim.record(&recorder);
+    }
+    if (!options.physicsLog.empty() && sim.logPhysics(options.physicsLog))
+        return -1;
+    lgw::ReplayReader input;
+    if (!options.input.empty() && input.open(options.input))
+        return -1;
+    uint32_t heldKeys = 0;
+    std::vector<lgw::InputEvent> events;
+
+    // physics settings can be changed while the server runs, like in the game
+    lgw::Settings::Hook physics = [&](lgw::Settings& changed) {
+        sim.tune(changed.physics_error_margin, stepTime, changed.physics_max_substeps);
+    };
+    settings.onChange("physics_error_margin", physics);
+    settings.onChange("physics_max_substeps", physics);
+    settings.watch();
+
+    stopRequested = 0;
+    std::signal(SIGINT, requestStop);
+    std::signal(SIGTERM, requestStop);
+    std::cout << "server: " << options.level << ", " << 1.0 / stepTime << " steps/s" << (options.fast ? " as fast as possible" : "")
+        << (options.steps > 0 ? ", " + std::to_string(options.steps) + " steps" : std::string(", until stopped")) << std::endl;
+
+    lgw::FramePacer pacer(options.fast ? 0.0 : stepTime, 0.0);
+    lgw::Stopwatch runStopwatch;
+    lgw::Stopwatch reportStopwatch;
+    long long reportSteps = 0;
+    double reportTime = 0.0, reportMax = 0.0;
+    while (!stopRequested && (options.steps <= 0 || sim.steps() < options.steps))
+    {
+        settings.update();
+        if (!options.input.empty())
+        {
+            replayInput(input, heldKeys, events);
+            sim.pushInput(events);
+        }
+
+        double cpu = sim.advance(stepTime);
+        reportSteps++;
+        reportTime += cpu;
+        reportMax = std::max(reportMax, cpu);
+        if (options.report > 0.0 && reportStopwatch.get() >= options.report)
+        {
+            std::cout << "server: step " << sim.steps() << ", " << reportSteps / reportStopwatch.get() << " steps/s, "
+                << reportTime / reportSteps * 1000.0 << " ms/step avg, " << reportMax * 1000.0 << " ms max, "
+                << pacer.missedFrames() << " late" << std::endl;
+            reportSteps = 0;
+            reportTime = 0.0;
+            reportMax = 0.0;
+            reportStopwatch.reset();
+        }
+
+        pacer.wait();
+    }
+
+    // closes the recording
+    sim.stop();
+    double runTime = runStopwatch.get();
+    std::cout << "server: stopped after " << sim.steps() << " steps in " << runTime << " s ("
+        << (runTime > 0.0 ? sim.steps() / runTime : 0.0) << " steps/s)" << std::endl;
+    return 0;
+}
+
+// replay
+int runReplay(lgw::Settings& settings, const std::string& path)
+{
+    lgw::ReplayReader reader;
+    if (reader.open(path))
+        return -1;
+    lgw::Level level;
+    if (loadLevel(reader.level(), level))
+    {
+        std::cout << "replay: failed to load the level " << reader.level() << std::endl;
+        return -1;
+    }
+    Simulation replayed(settings, level);
+    return replayed.replay(reader);
+}
+
+#ifdef LGW_HEADLESS
+// headless builds have no window, so the server (or a replay) is all they run
+int main(int argc, char** argv)
+{
+    lgw::Settings settings(CONST::SETTINGS_DIR);
+    if (settings.load() == -1)
+    {
+        std::cout << "Settings file not found" << std::endl;
+        return -1;
+    }
+    if (argc > 1 && std::string(argv[1]) == "--replay")
+    {
+        if (argc != 3)
+        {
+            std::cout << "usage: --replay <replay file>" << std::endl;
+            return -1;
+        }
+        return runReplay(settings, argv[2]);
+    }
+    return runServer(settings, argc, argv);
+}
+#endif
\ No newline at end of file
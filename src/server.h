@@ -0,0 +1,25 @@
+#pragma once
+
+// local headers
+#include "lgwrap/lgwrap.h"
+
+// headless server: runs input, simulation and game logic without a window, a GL context or FreeType, on a fixed clock
+// (every step advances the simulation by the same time, in real time or as fast as possible); stops after the
+// requested number of steps or on Ctrl+C
+//
+// usage: "2D platformer" --server [options]   (headless builds run the server without --server)
+//   --level FILE     level to simulate (default: level_dir from the settings file)
+//   --rate N         simulation steps per second (default: fps_cap from the settings file, 60 if it's uncapped)
+//   --fast           don't wait between steps (bulk simulation)
+//   --steps N        stop after N steps (default: run until stopped)
+//   --input FILE     drive the player with the keys of a replay file
+//   --record FILE    record the session into a replay file
+//   --physics-log FILE  write the physics counters of every step to a file (JSON lines)
+//   --report N       print the step rate and step time every N seconds (default 10, 0 turns it off)
+int runServer(lgw::Settings& settings, int argc, char** argv);
+
+// re-run a recorded session as fast as possible and check it against the recording (returns 0 if every state hash
+// matched, 1 if the simulation diverged and -1 if the replay couldn't be read)
+//
+// usage: "2D platformer" --replay FILE
+int runReplay(lgw::Settings& settings, const std::string& path);
\ No newline at end of file
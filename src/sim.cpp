@@ -0,0 +1,530 @@
+// standard libraries
+#include <iostream> // for the replay report
+#include <chrono> // for timing the replay
+#include <cmath> // for std::fabs and std::ceil
+
+// public (external) libraries
+#ifndef LGW_HEADLESS
+#include <glad/glad.h> // loader for OpenGL (has to come before GLFW)
+#endif
+#include <GLFW/glfw3.h> // for the key codes
+
+// local headers
+#include "sim.h"
+
+// simulation: keys the simulation reads
+const int Simulation::inputKeys[5] = { GLFW_KEY_W, GLFW_KEY_A, GLFW_KEY_S, GLFW_KEY_D, GLFW_KEY_T };
+
+// simulation: constructor
+Simulation::Simulation(const lgw::Settings& settings, const lgw::Level& level)
+    : physicsErrorMargin(settings.physics_error_margin), maxSubsteps(settings.physics_max_substeps),
+    worldWidth(level.width()), worldHeight(level.height()),
+    secondsPerStep(settings.spf_cap),
+    tunedErrorMargin(settings.physics_error_margin), tunedSecondsPerStep(settings.spf_cap), tunedMaxSubsteps(settings.physics_max_substeps),
+    playerInitPos((level.width() / 2.0f) - 0.5f, 0.0f),
+    player(playerInitPos, lgw::Point(playerInitPos.x + 1.0f, playerInitPos.y + 1.0f)),
+    running(false)
+{
+    // the player starts at the level's spawn point (or at the bottom center of the world if it doesn't have one)
+    if (level.spawn(lgw::SpawnKind::PLAYER, playerInitPos))
+    {
+        player.p1 = playerInitPos;
+        player.p2 = playerInitPos + 1.0f;
+    }
+    // handing input over doesn't allocate unless a burst outgrows the input queues
+    inbox.reserve(lgwcon::INPUT_QUEUE_RESERVE);
+    upcoming.reserve(lgwcon::INPUT_QUEUE_RESERVE);
+    // the player and the edges of the world are entities too, so contacts can refer to them
+    playerEntity = world.spawn();
+    ground = world.spawn();
+    leftWall = world.spawn();
+    rightWall = world.spawn();
+    ceiling = world.spawn();
+    // the barriers as well (only the horizontal and vertical ones collide)
+    const lgw::LevelRects& levelBarriers = level.barriers();
+    for (uint32_t i = 0; i < levelBarriers.count; i++)
+    {
+        lgw::Point p1(levelBarriers.x1[i], levelBarriers.y1[i]);
+        lgw::Point p2(levelBarriers.x2[i], levelBarriers.y2[i]);
+        bool horizontal = std::fabs(p2.y - p1.y) <= physicsErrorMargin;
+        if (!horizontal && std::fabs(p2.x - p1.x) > physicsErrorMargin)
+            continue;
+        lgw::Box box(p1, p2);
+        barrierGrid.insert(box);
+        barriers.push_back({ box.p1, box.p2, horizontal, world.spawn() });
+    }
+    nearbyBarriers.reserve(barriers.size());
+    const lgw::LevelRects& levelBodies = level.bodies();
+    for (uint32_t i = 0; i < levelBodies.count; i++)
+    {
+        lgw::Color color;
+        levelBodies.unpackColor(i, color.rgba);
+        world.spawnBody(lgw::Point(levelBodies.x1[i], levelBodies.y1[i]), lgw::Point(levelBodies.x2[i], levelBodies.y2[i]), color);
+    }
+}
+// simulation: destructor
+Simulation::~Simulation(void)
+{
+    stop();
+}
+// simulation: publish the initial state and start the simulation thread
+void Simulation::start(void)
+{
+    if (running)
+        return;
+    // the render thread gets a state to draw before the first step is done
+    publish(0.0, 0, 0.0);
+    snapshots.update();
+    running = true;
+    thread = std::thread(&Simulation::run, this);
+}
+// simulation: stop the simulation thread
+void Simulation::stop(void)
+{
+    running = false;
+    if (thread.joinable())
+        thread.join();
+    if (recorder != nullptr && recorder->isOpen())
+        recorder->close(stepCount, stateHash());
+}
+// simulation: change the tunable settings
+void Simulation::tune(float errorMargin, double stepTime, int substepLimit)
+{
+    tunedErrorMargin = errorMargin;
+    tunedSecondsPerStep = stepTime;
+    tunedMaxSubsteps = substepLimit;
+}
+// simulation: queue input events received by the main thread
+void Simulation::pushInput(const std::vector<lgw::InputEvent>& events)
+{
+    if (events.empty())
+        return;
+    std::lock_guard<std::mutex> lock(inputMutex);
+    inbox.insert(inbox.end(), events.begin(), events.end());
+}
+// simulation: apply the input events that happened before the step starting at 'stepStart'
+void Simulation::applyInput(double stepStart)
+{
+    {
+        std::lock_guard<std::mutex> lock(inputMutex);
+        upcoming.insert(upcoming.end(), inbox.begin(), inbox.end());
+        inbox.clear();
+    }
+    // events arrive in order, so the ones for this step are at the front
+    keys.clearEdges();
+    size_t applied = 0;
+    while (applied < upcoming.size() && upcoming[applied].time <= stepStart)
+    {
+        keys.apply(upcoming[applied]);
+        latencySum += stepStart - upcoming[applied].time;
+        latencyCount++;
+        applied++;
+    }
+    upcoming.erase(upcoming.begin(), upcoming.begin() + applied);
+}
+// simulation: simulation loop
+void Simulation::run(void)
+{
+    lgw::FramePacer pacer(secondsPerStep, 0.0);
+    lgw::Stopwatch rateStopwatch;
+    int stepsThisSecond = 0;
+    int rate = 0;
+    double inputLatency = 0.0;
+    // the first step uses the target step time since there's no previous step to measure
+    double timeElapsed = secondsPerStep > 0.0 ? secondsPerStep : 1.0 / 60.0;
+    while (running)
+    {
+        // pick up a step time changed by the main thread
+        if (tunedSecondsPerStep.load() != secondsPerStep)
+        {
+            secondsPerStep = tunedSecondsPerStep.load();
+            pacer.setTarget(secondsPerStep, 0.0);
+        }
+
+        double stepTime = advance(timeElapsed);
+
+        stepsThisSecond++;
+        if (rateStopwatch.get() >= 1.0)
+        {
+            rate = stepsThisSecond;
+            inputLatency = latencyCount > 0 ? latencySum / latencyCount : 0.0;
+            stepsThisSecond = 0;
+            latencySum = 0.0;
+            latencyCount = 0;
+            rateStopwatch.reset();
+        }
+        publish(stepTime, rate, inputLatency);
+
+        // wait until the next step
+        timeElapsed = pacer.wait();
+    }
+}
+// simulation: apply the queued input and advance by one step on the calling thread
+double Simulation::advance(double timeElapsed)
+{
+    // pick up settings changed by the main thread
+    physicsErrorMargin = tunedErrorMargin.load();
+    maxSubsteps = tunedMaxSubsteps.load();
+
+    lgw::Stopwatch stepStopwatch;
+    applyInput(lgw::getTime());
+    if (recorder != nullptr)
+    {
+        recorder->tune(physicsErrorMargin, maxSubsteps);
+        recorder->step(keys, (float)timeElapsed);
+    }
+    step((float)timeElapsed);
+    double stepTime = stepStopwatch.get();
+    if (recorder != nullptr && stepCount % lgwcon::REPLAY_CHECKPOINT_INTERVAL == 0)
+        recorder->checkpoint(stepCount, stateHash());
+    return stepTime;
+}
+// simulation: advance the simulation by one step
+void Simulation::step(float timeElapsed)
+{
+    lgw::MemScope memScope(lgw::MemTag::PHYSICS);
+    stepCount++;
+    lgw::Vector playerMoved = { 0.0f, 0.0f };
+
+    // move the player to a set location when the 'T' key is pressed
+    if (keys.held(GLFW_KEY_T))
+    {
+        player.velocity.x = 0.0f;
+        player.velocity.y = 0.0f;
+        player.p1 = playerInitPos;
+        player.p2 = playerInitPos + 1.0f;
+    }
+
+    // player movement
+    if (canJump && keys.held(GLFW_KEY_W))
+        playerMoved.y = 7.0f / timeElapsed;
+    else if (keys.held(GLFW_KEY_S))
+        playerMoved.y = -0.2f / timeElapsed;
+    if (keys.held(GLFW_KEY_D))
+        playerMoved.x = 0.2f / timeElapsed;
+    else if (keys.held(GLFW_KEY_A))
+        playerMoved.x = -0.2f / timeElapsed;
+
+    // fast bodies are moved in several smaller substeps so they can't skip over anything, calm scenes take one
+    substeps = substepCount(timeElapsed, playerMoved);
+    float substepTime = timeElapsed / substeps;
+    counters.reset();
+    contacts.begin();
+    for (int i = 0; i < substeps; i++)
+        substep(substepTime, playerMoved);
+    double contactStart = lgw::getTime();
+    contacts.finish();
+
+    // gameplay reactions to the step's contacts
+    handleContacts();
+    counters.contactsResolved = (int)contacts.events().size();
+    counters.contactTime = lgw::getTime() - contactStart;
+    if (physicsLog.is_open())
+        counters.writeJSON(physicsLog, stepCount, substeps);
+}
+// simulation: react to the contact events of the last step
+void Simulation::handleContacts(void)
+{
+    // the player can jump while it stands on something (a contact that pushes it up)
+    canJump = false;
+    for (const lgw::ContactEvent& event : contacts.events())
+    {
+        if (event.a == playerEntity && event.phase != lgw::ContactPhase::END && !event.sensor && event.normal.y > 0.5f)
+            canJump = true;
+    }
+}
+// simulation: number of substeps the next step needs
+int Simulation::substepCount(float timeElapsed, lgw::Vector playerMoved)
+{
+    // fastest speed any body can reach during the step (its velocity plus what the step's acceleration adds) and the
+    // smallest extent of any body
+    float maxSpeed = std::fabs(player.velocity.x) + std::fabs(playerMoved.x * timeElapsed)
+        + std::fabs(player.velocity.y) + std::fabs((playerMoved.y + gravity) * timeElapsed);
+    float minExtent = std::fmin(player.p2.x - player.p1.x, player.p2.y - player.p1.y);
+    for (uint32_t i = 0; i < world.bodies.size(); i++)
+    {
+        const lgw::Vector& velocity = world.bodies[i].velocity;
+        maxSpeed = std::fmax(maxSpeed, std::fabs(velocity.x) + std::fabs(velocity.y) + std::fabs(gravity * timeElapsed));
+        const lgw::Transform* body = world.transforms.get(world.bodies.owner(i));
+        if (body != nullptr)
+            minExtent = std::fmin(minExtent, std::fmin(body->p2.x - body->p1.x, body->p2.y - body->p1.y));
+    }
+    if (minExtent <= 0.0f)
+        return 1;
+    // no body may travel more than a fraction of the smallest extent in one substep
+    float count = std::ceil(maxSpeed * timeElapsed / (minExtent * substepTravel));
+    if (!(count >= 1.0f))
+        return 1;
+    return count >= (float)maxSubsteps ? maxSubsteps : (int)count;
+}
+// simulation: advance the simulation by one substep
+void Simulation::substep(float timeElapsed, lgw::Vector playerMoved)
+{
+    double phaseStart = lgw::getTime();
+    // move the player
+    player.calcTimeStep(timeElapsed, playerMoved.x, playerMoved.y + gravity);
+
+    lgw::Point playerLeft(player.p1.x, player.p2.y);
+    // detect and resolve collisions
+    lgw::voidMinorPosDiff(player.p1, playerLeft, physicsErrorMargin);
+    counters.bodiesIntegrated++;
+    double phaseEnd = lgw::getTime();
+    counters.integrateTime += phaseEnd - phaseStart;
+    phaseStart = phaseEnd;
+
+    // contacts with the edges of the world are reported to the contact buffer (the gameplay code reads them after the
+    // step; the impulse is the velocity the push removed)
+    counters.broadphasePairs += 4;
+    counters.narrowphaseTests += 4;
+    if (player.p1.x < 0.0f)
+    {
+        contacts.add(playerEntity, leftWall, lgw::Vector(1.0f, 0.0f), std::fabs(player.velocity.x));
+        player.p1.x = 0.0f;
+        player.p2.x = 1.0f;
+        player.velocity.x = 0.0f;
+        counters.hits++;
+    }
+    else if (player.p2.x > worldWidth)
+    {
+        contacts.add(playerEntity, rightWall, lgw::Vector(-1.0f, 0.0f), std::fabs(player.velocity.x));
+        player.p1.x = worldWidth - 1.0f;
+        player.p2.x = worldWidth;
+        player.velocity.x = 0.0f;
+        counters.hits++;
+    }
+
+    if (player.p1.y < 0.0f)
+    {
+        contacts.add(playerEntity, ground, lgw::Vector(0.0f, 1.0f), std::fabs(player.velocity.y));
+        player.p1.y = 0.0f;
+        player.p2.y = 1.0f;
+        player.velocity.y = 0.0f;
+        counters.hits++;
+    }
+    else if (player.p2.y > worldHeight)
+    {
+        contacts.add(playerEntity, ceiling, lgw::Vector(0.0f, -1.0f), std::fabs(player.velocity.y));
+        player.p1.y = worldHeight - 1.0f;
+        player.p2.y = worldHeight;
+        player.velocity.y = 0.0f;
+        counters.hits++;
+    }
+    collideBarriers(playerEntity, player.p1, player.p2, player.prev_p1, player.prev_p2, player.velocity);
+    phaseEnd = lgw::getTime();
+    counters.collideTime += phaseEnd - phaseStart;
+    phaseStart = phaseEnd;
+
+    // dynamic bodies fall until they reach the bottom of the world
+    world.integrate(timeElapsed, 0.0f, gravity);
+    counters.bodiesIntegrated += (int)world.bodies.size();
+    phaseEnd = lgw::getTime();
+    counters.integrateTime += phaseEnd - phaseStart;
+    phaseStart = phaseEnd;
+
+    // bodies touch the ground, the side walls and the barriers
+    counters.broadphasePairs += 3 * (int)world.bodies.size();
+    counters.narrowphaseTests += 3 * (int)world.bodies.size();
+    int resting = 0;
+    for (uint32_t i = 0; i < world.bodies.size(); i++)
+    {
+        lgw::Entity entity = world.bodies.owner(i);
+        lgw::Transform& body = *world.transforms.get(entity);
+        lgw::Vector& velocity = world.bodies[i].velocity;
+        float width = body.p2.x - body.p1.x;
+        float height = body.p2.y - body.p1.y;
+        if (body.p1.y < 0.0f)
+        {
+            contacts.add(entity, ground, lgw::Vector(0.0f, 1.0f), std::fabs(velocity.y));
+            body.p1.y = 0.0f;
+            body.p2.y = height;
+            velocity.y = 0.0f;
+            counters.hits++;
+        }
+        if (body.p1.x < 0.0f)
+        {
+            contacts.add(entity, leftWall, lgw::Vector(1.0f, 0.0f), std::fabs(velocity.x));
+            body.p1.x = 0.0f;
+            body.p2.x = width;
+            velocity.x = 0.0f;
+            counters.hits++;
+        }
+        else if (body.p2.x > worldWidth)
+        {
+            contacts.add(entity, rightWall, lgw::Vector(-1.0f, 0.0f), std::fabs(velocity.x));
+            body.p1.x = worldWidth - width;
+            body.p2.x = worldWidth;
+            velocity.x = 0.0f;
+            counters.hits++;
+        }
+        collideBarriers(entity, body.p1, body.p2, body.prev_p1, body.prev_p2, velocity);
+        if (velocity.x == 0.0f && velocity.y == 0.0f && (body.p1.y == 0.0f || body.p1.y == body.prev_p1.y))
+            resting++;
+    }
+    // only the bodies at rest after the last substep count
+    counters.sleepingBodies = resting;
+    counters.collideTime += lgw::getTime() - phaseStart;
+}
+// simulation: push a box that crossed a barrier during the substep back to the side it came from
+void Simulation::collideBarriers(lgw::Entity entity, lgw::Point& p1, lgw::Point& p2, const lgw::Point& prev_p1, const lgw::Point& prev_p2, lgw::Vector& velocity)
+{
+    if (barriers.empty())
+        return;
+    // only the barriers near the area the box swept through can have been crossed
+    lgw::Box swept(lgw::Point(std::fmin(p1.x, prev_p1.x), std::fmin(p1.y, prev_p1.y)), lgw::Point(std::fmax(p2.x, prev_p2.x), std::fmax(p2.y, prev_p2.y)));
+    nearbyBarriers.clear();
+    int found = barrierGrid.query(swept, nearbyBarriers);
+    counters.broadphasePairs += found;
+    counters.narrowphaseTests += found;
+    for (int id : nearbyBarriers)
+    {
+        const Barrier& barrier = barriers[id];
+        // a box that only slides along the end of a barrier doesn't touch it
+        if (barrier.horizontal)
+        {
+            float y = barrier.p1.y;
+            if (p2.x <= barrier.p1.x || p1.x >= barrier.p2.x)
+                continue;
+            if (prev_p1.y >= y && p1.y < y)
+            {
+                contacts.add(entity, barrier.entity, lgw::Vector(0.0f, 1.0f), std::fabs(velocity.y));
+                p2.y += y - p1.y;
+                p1.y = y;
+            }
+            else if (prev_p2.y <= y && p2.y > y)
+            {
+                contacts.add(entity, barrier.entity, lgw::Vector(0.0f, -1.0f), std::fabs(velocity.y));
+                p1.y -= p2.y - y;
+                p2.y = y;
+            }
+            else
+            {
+                continue;
+            }
+            velocity.y = 0.0f;
+        }
+        else
+        {
+            float x = barrier.p1.x;
+            if (p2.y <= barrier.p1.y || p1.y >= barrier.p2.y)
+                continue;
+            if (prev_p1.x >= x && p1.x < x)
+            {
+                contacts.add(entity, barrier.entity, lgw::Vector(1.0f, 0.0f), std::fabs(velocity.x));
+                p2.x += x - p1.x;
+                p1.x = x;
+            }
+            else if (prev_p2.x <= x && p2.x > x)
+            {
+                contacts.add(entity, barrier.entity, lgw::Vector(-1.0f, 0.0f), std::fabs(velocity.x));
+                p1.x -= p2.x - x;
+                p2.x = x;
+            }
+            else
+            {
+                continue;
+            }
+            velocity.x = 0.0f;
+        }
+        counters.hits++;
+    }
+}
+// simulation: re-run a recorded session
+int Simulation::replay(lgw::ReplayReader& reader)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    double maxStepTime = 0.0;
+    lgw::ReplayRecord record;
+    int result = 0;
+    while (result == 0 && reader.next(record))
+    {
+        switch (record.type)
+        {
+        case lgw::ReplayRecord::TUNE:
+            physicsErrorMargin = record.errorMargin;
+            maxSubsteps = record.maxSubsteps;
+            break;
+        case lgw::ReplayRecord::STEP:
+        {
+            reader.apply(record.keys, keys);
+            std::chrono::steady_clock::time_point stepStart = std::chrono::steady_clock::now();
+            step(record.timeElapsed);
+            maxStepTime = std::fmax(maxStepTime, std::chrono::duration<double>(std::chrono::steady_clock::now() - stepStart).count());
+            break;
+        }
+        case lgw::ReplayRecord::CHECKPOINT:
+        case lgw::ReplayRecord::END:
+            if (record.step != stepCount || record.hash != stateHash())
+            {
+                std::cout << "replay: state diverged from the recording at step " << record.step << " (ran " << stepCount << " steps)" << std::endl;
+                result = 1;
+            }
+            break;
+        }
+    }
+    if (result == 0 && reader.truncated())
+    {
+        std::cout << "replay: the recording ends without an END record after step " << stepCount << std::endl;
+        result = -1;
+    }
+
+    double total = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "replay: " << stepCount << " steps in " << total * 1000.0 << " ms (" << (total > 0.0 ? stepCount / total : 0.0)
+        << " steps/s, " << (stepCount > 0 ? total / stepCount * 1000.0 : 0.0) << " ms/step avg, " << maxStepTime * 1000.0 << " ms max)";
+    std::cout << (result == 0 ? ", every state hash matched" : "") << std::endl;
+    return result;
+}
+// simulation: write the physics counters of every step to a file
+int Simulation::logPhysics(const std::string& path)
+{
+    physicsLog.open(path, std::ios::trunc);
+    if (!physicsLog.is_open())
+    {
+        std::cout << "physics: failed to write " << path << std::endl;
+        return -1;
+    }
+    return 0;
+}
+// simulation: hash of everything a step changes
+unsigned long long Simulation::stateHash(void)
+{
+    unsigned long long hash = lgw::hashBytes(&stepCount, sizeof(stepCount));
+    const float playerState[6] = { player.p1.x, player.p1.y, player.p2.x, player.p2.y, player.velocity.x, player.velocity.y };
+    hash = lgw::hashBytes(playerState, sizeof(playerState), hash);
+    hash = lgw::hashBytes(&canJump, sizeof(canJump), hash);
+    for (uint32_t i = 0; i < world.bodies.size(); i++)
+    {
+        const lgw::Transform* body = world.transforms.get(world.bodies.owner(i));
+        const lgw::Vector& velocity = world.bodies[i].velocity;
+        const float bodyState[6] = { body->p1.x, body->p1.y, body->p2.x, body->p2.y, velocity.x, velocity.y };
+        hash = lgw::hashBytes(bodyState, sizeof(bodyState), hash);
+    }
+    return hash;
+}
+// simulation: write the current state into the triple buffer
+void Simulation::publish(double stepTime, int rate, double inputLatency)
+{
+    // every field is overwritten, since the buffer still holds a state from two publishes ago
+    SimSnapshot& snapshot = snapshots.write();
+    snapshot.step = stepCount;
+    snapshot.playerP1 = player.p1;
+    snapshot.playerP2 = player.p2;
+    for (int i = 0; i < 4; i++)
+        snapshot.playerColor[i] = playerColor[i];
+    snapshot.canJump = canJump;
+    snapshot.substeps = substeps;
+    snapshot.contacts = (int)contacts.touching();
+    snapshot.physics = counters;
+    world.updateRects();
+    snapshot.bodies.resize(world.rects.size());
+    snapshot.bodyColors.resize(world.rects.size());
+    for (uint32_t i = 0; i < world.rects.size(); i++)
+    {
+        snapshot.bodies[i] = world.rects[i].box;
+        const lgw::Color* color = world.colors.get(world.rects.owner(i));
+        snapshot.bodyColors[i] = color != nullptr ? *color : lgw::Color();
+    }
+    snapshot.stepTime = stepTime;
+    snapshot.rate = rate;
+    snapshot.inputLatency = inputLatency;
+    snapshots.publish();
+}
\ No newline at end of file
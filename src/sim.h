@@ -0,0 +1,151 @@
+#pragma once
+
+// standard libraries
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <fstream>
+
+// local headers
+#include "lgwrap/lgwrap.h"
+
+// everything the render thread needs from one simulation step (a complete, immutable copy)
+struct SimSnapshot {
+    // number of the step that produced the snapshot
+    long long step = 0;
+    // player
+    lgw::Point playerP1, playerP2;
+    float playerColor[4] = { 0.0f };
+    bool canJump = false;
+    // number of substeps the step was split into and number of touching pairs after it
+    int substeps = 1;
+    int contacts = 0;
+    // work done by the physics during the step
+    lgw::PhysicsCounters physics;
+    // dynamic bodies and their colors (in the order of the world's body arrays, which changes when bodies despawn)
+    std::vector<lgw::Box> bodies;
+    std::vector<lgw::Color> bodyColors;
+    // CPU time of the step and steps per second (averaged over the last second)
+    double stepTime = 0.0;
+    int rate = 0;
+    // average time from an input event to the step that applied it (over the last second)
+    double inputLatency = 0.0;
+};
+
+// runs the game simulation on its own thread and publishes a snapshot after every step through a triple buffer,
+// so simulating step N+1 overlaps with rendering step N
+class Simulation {
+public:
+    // constructor (copies the settings and the parts of the level it needs, so the main thread can keep changing them)
+    Simulation(const lgw::Settings& settings, const lgw::Level& level);
+    // destructor
+    ~Simulation(void);
+    // publish the initial state and start the simulation thread
+    void start(void);
+    // stop the simulation thread
+    void stop(void);
+    // change the tunable settings (takes effect at the start of the next step)
+    void tune(float errorMargin, double stepTime, int substepLimit);
+    // queue input events received by the main thread (GLFW can only be polled there); each event is applied by the
+    // first step that starts after its timestamp
+    void pushInput(const std::vector<lgw::InputEvent>& events);
+    // apply the queued input and advance by one step on the calling thread (for headless runs that have no render
+    // thread to overlap with; don't mix with start; returns the CPU time of the step)
+    double advance(double timeElapsed);
+    // number of steps taken so far
+    inline long long steps(void) const { return stepCount; }
+    // record the input and step time of every step into a replay (call before start; the replay is closed by stop)
+    inline void record(lgw::ReplayWriter* writer) { recorder = writer; }
+    // re-run a recorded session on the calling thread as fast as possible and check the state hashes in the recording
+    // (returns 0 if every hash matched, 1 if the simulation diverged and -1 if the replay is damaged)
+    int replay(lgw::ReplayReader& reader);
+    // write the physics counters of every step to a file, one JSON object per line (call before start; returns 0 on
+    // success and -1 if the file couldn't be created)
+    int logPhysics(const std::string& path);
+    // keys the simulation reads (the ones a replay records)
+    static const int inputKeys[5];
+    // take the newest snapshot (returns false if nothing new was published since the last call)
+    inline bool poll(void) { return snapshots.update(); }
+    // snapshot taken by the last poll
+    inline const SimSnapshot& snapshot(void) const { return snapshots.read(); }
+private:
+    // settings (copies)
+    float physicsErrorMargin;
+    int maxSubsteps;
+    // size of the world (from the level)
+    float worldWidth;
+    float worldHeight;
+    double secondsPerStep;
+    // tunable settings written by the main thread
+    std::atomic<float> tunedErrorMargin;
+    std::atomic<double> tunedSecondsPerStep;
+    std::atomic<int> tunedMaxSubsteps;
+    // player
+    lgw::Point playerInitPos;
+    lgw::Object player;
+    float playerColor[4] = { 0.0f, 0.5f, 1.0f, 1.0f };
+    float gravity = -9.8f;
+    // fraction of the smallest body extent that a body may travel in one substep
+    float substepTravel = 0.5f;
+    // number of substeps the last step was split into
+    int substeps = 1;
+    bool canJump = false;
+    // entities (the level's dynamic bodies, and anything spawned while the game runs)
+    lgw::World world;
+    // entities of the player and of the edges of the world
+    lgw::Entity playerEntity;
+    lgw::Entity ground, leftWall, rightWall, ceiling;
+    // the level's horizontal and vertical barriers (bucketed by the grid, whose IDs are indices into the array; other
+    // barriers are only drawn) and the IDs found by the last grid query
+    struct Barrier {
+        lgw::Point p1, p2;
+        bool horizontal;
+        lgw::Entity entity;
+    };
+    std::vector<Barrier> barriers;
+    lgw::SpatialGrid barrierGrid;
+    std::vector<int> nearbyBarriers;
+    // contacts found by the last step
+    lgw::ContactBuffer contacts;
+    // physics counters of the current step, and the file they're logged to (closed when not logging)
+    lgw::PhysicsCounters counters;
+    std::ofstream physicsLog;
+    // input events handed over by the main thread
+    std::mutex inputMutex;
+    std::vector<lgw::InputEvent> inbox;
+    // events taken from the inbox that are newer than the current step
+    std::vector<lgw::InputEvent> upcoming;
+    // key state seen by the current step
+    lgw::InputState keys;
+    // replay that every step is recorded into (nullptr when not recording)
+    lgw::ReplayWriter* recorder = nullptr;
+    // input latency accumulated over the current second
+    double latencySum = 0.0;
+    int latencyCount = 0;
+    // snapshots handed to the render thread
+    lgw::TripleBuffer<SimSnapshot> snapshots;
+    // thread
+    std::thread thread;
+    std::atomic<bool> running;
+    long long stepCount = 0;
+    // simulation loop
+    void run(void);
+    // apply the input events that happened before the step starting at 'stepStart'
+    void applyInput(double stepStart);
+    // advance the simulation by one step
+    void step(float timeElapsed);
+    // number of substeps a step needs (from the fastest body and the smallest body extent, capped by the settings)
+    int substepCount(float timeElapsed, lgw::Vector playerMoved);
+    // advance the simulation by one substep (playerMoved is the player's acceleration from the input)
+    void substep(float timeElapsed, lgw::Vector playerMoved);
+    // push a box that crossed a barrier during the substep back to the side it came from
+    void collideBarriers(lgw::Entity entity, lgw::Point& p1, lgw::Point& p2, const lgw::Point& prev_p1, const lgw::Point& prev_p2, lgw::Vector& velocity);
+    // react to the contact events of the last step
+    void handleContacts(void);
+    // hash of everything a step changes (the player, the bodies and the step number)
+    unsigned long long stateHash(void);
+    // write the current state into the triple buffer
+    void publish(double stepTime, int rate, double inputLatency);
+};
\ No newline at end of file